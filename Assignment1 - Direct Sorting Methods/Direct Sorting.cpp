@@ -23,7 +23,9 @@
  */
 
 #include <iostream>
+#ifdef _WIN32
 #include <conio.h>
+#endif
 #include "Profiler.h"
 
 #define MAX_SIZE 10000
@@ -50,12 +52,14 @@ void printArray(int *intArray, int size) {
 
 /**
  * Sorting algorithms
+ * the array is an int * or a CountedArray<int>, which counts the accesses by itself (see the benchmark driver)
  */
 
-void selectionSort(int *intArray, int size) {
+template <typename Counter = DefaultOperation, typename Array>
+void selectionSort(Array intArray, int size) {
 	// used by the profiler
-	Operation assignments = profiler.createOperation("selectionSortAss", size);
-	Operation comparisons = profiler.createOperation("selectionSortComp", size);
+	Counter assignments = profiler.createCounter<Counter>("selectionSortAss", size);
+	Counter comparisons = profiler.createCounter<Counter>("selectionSortComp", size);
 
 	int i, j, minPos;
 	for (i = 0; i < size - 1; i++) {
@@ -78,10 +82,11 @@ void selectionSort(int *intArray, int size) {
 	}
 }
 
-void bubbleSort(int *intArray, int size) {
+template <typename Counter = DefaultOperation, typename Array>
+void bubbleSort(Array intArray, int size) {
 	// used by the profiler
-	Operation assignments = profiler.createOperation("bubbleSortAss", size);
-	Operation comparisons = profiler.createOperation("bubbleSortComp", size);
+	Counter assignments = profiler.createCounter<Counter>("bubbleSortAss", size);
+	Counter comparisons = profiler.createCounter<Counter>("bubbleSortComp", size);
 
 	bool done;
 	do {
@@ -101,10 +106,11 @@ void bubbleSort(int *intArray, int size) {
 	} while (done == false);
 }
 
-void insertionSort(int *intArray, int size) {
+template <typename Counter = DefaultOperation, typename Array>
+void insertionSort(Array intArray, int size) {
 	// used by the profiler
-	Operation assignments = profiler.createOperation("insertionSortAss", size);
-	Operation comparisons = profiler.createOperation("insertionSortComp", size);
+	Counter assignments = profiler.createCounter<Counter>("insertionSortAss", size);
+	Counter comparisons = profiler.createCounter<Counter>("insertionSortComp", size);
 
 	int temp = 0, j, i;
 	for (i = 1; i < size; i++) {
@@ -131,45 +137,32 @@ void insertionSort(int *intArray, int size) {
 	}
 }
 
-void averageCase(void) {
-	int base[MAX_SIZE], toOrder[MAX_SIZE], size, samples;
+// the distribution is one of the names known by FillDistributedArray
+void averageCase(const char *distribution = "uniform") {
+	int toOrder[MAX_SIZE], size;
+	// the sorts are quadratic, so the number of samples of a point is capped lower than the default
+	BenchmarkRunner runner(profiler, 0.95, 0.05, 5, 20);
 
 	for (size = 100; size < MAX_SIZE; size += 100) {
-		// since we are in the average case, the number of experiments is > 1 and we take the mean value.
-		for (samples = 0; samples < 5; samples++) {
-			FillRandomArray(base, size);
-			
-			// we need to make a copy of the randomly generated array, since the sorting fuctions alterate the array given as parameter 
-			CopyArray(toOrder, base, size);
-			selectionSort(toOrder, size);
-
-			CopyArray(toOrder, base, size);
-			bubbleSort(toOrder, size);
-
-			CopyArray(toOrder, base, size);
-			insertionSort(toOrder, size);
-		}
+		// since we are in the average case, every point is sampled until its mean is known well enough
+		// and the sorting functions are given a new array of the distribution for every sample.
+		// the accesses are counted by CountedArray, the same way for the three sorts (a swap is one swap, a shift
+		// is a read and a write), instead of the assignments and comparisons counted by hand
+		runner.runCounted("selectionSort", size, [&]() { FillDistributedArray(toOrder, size, distribution); }, [&](CountedOperations<> &operations) {
+			selectionSort<NullOperation>(CountedArray<int>(toOrder, operations), size);
+		});
+		runner.runCounted("bubbleSort", size, [&]() { FillDistributedArray(toOrder, size, distribution); }, [&](CountedOperations<> &operations) {
+			bubbleSort<NullOperation>(CountedArray<int>(toOrder, operations), size);
+		});
+		runner.runCounted("insertionSort", size, [&]() { FillDistributedArray(toOrder, size, distribution); }, [&](CountedOperations<> &operations) {
+			insertionSort<NullOperation>(CountedArray<int>(toOrder, operations), size);
+		});
 	}
 
-	profiler.addSeries("insertionSortTotal", "insertionSortAss", "insertionSortComp");
-	profiler.addSeries("selectionSortTotal", "selectionSortAss", "selectionSortComp");
-	profiler.addSeries("bubbleSortTotal", "bubbleSortAss", "bubbleSortComp");
-	
-	// take the mean value
-	profiler.divideValues("insertionSortTotal", 5);
-	profiler.divideValues("insertionSortAss", 5);
-	profiler.divideValues("insertionSortComp", 5);
-	profiler.divideValues("selectionSortTotal", 5);
-	profiler.divideValues("selectionSortAss", 5);
-	profiler.divideValues("selectionSortComp", 5);
-	profiler.divideValues("bubbleSortTotal", 5);
-	profiler.divideValues("bubbleSortAss", 5);
-	profiler.divideValues("bubbleSortComp", 5);
-
-	profiler.createGroup("comparisonsAverage", "insertionSortComp", "selectionSortComp", "bubbleSortComp");
-	profiler.createGroup("assignmentsAverage", "insertionSortAss", "selectionSortAss", "bubbleSortAss");
-	profiler.createGroup("selectionSortAs", "selectionSortAss");
-	profiler.createGroup("totalAverage", "insertionSortTotal", "selectionSortTotal", "bubbleSortTotal");
+	profiler.createGroup("comparisonsAverage", "insertionSort_comparisons", "selectionSort_comparisons", "bubbleSort_comparisons");
+	profiler.createGroup("readsAverage", "insertionSort_reads", "selectionSort_reads", "bubbleSort_reads");
+	profiler.createGroup("writesAverage", "insertionSort_writes", "selectionSort_writes", "bubbleSort_writes");
+	profiler.createGroup("swapsAverage", "insertionSort_swaps", "selectionSort_swaps", "bubbleSort_swaps");
 
 	profiler.reset("Worst Case Evaluation");
 }
@@ -240,6 +233,8 @@ void bestCase(void) {
 	profiler.reset("Done");
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 int main(void) {
 	/* int base[MAX_SIZE], toOrder[MAX_SIZE];
 
@@ -270,6 +265,9 @@ int main(void) {
 	worstCase();
 	bestCase();
 
+#ifdef _WIN32
 	_getch();
+#endif
 	return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
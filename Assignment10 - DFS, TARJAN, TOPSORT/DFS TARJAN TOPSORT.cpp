@@ -120,7 +120,8 @@ GraphT *generateRandomGraph(int nrVertices, int nrEdges)
     return newGraph;
 }
 
-void DFS(GraphT *graph, int sourceNode, Operation *o)
+template <typename Counter>
+void DFS(GraphT *graph, int sourceNode, Counter *o)
 {
     graph->nodeLists[sourceNode]->color = GREY;
     graph->nodeLists[sourceNode]->discoveryTime = ++globalTimer;
@@ -157,7 +158,7 @@ void DFS(GraphT *graph, int sourceNode, Operation *o)
         if (i == graph->nodeLists[temp]->adjNodes.end())
         {
             graph->nodeLists[temp]->color = BLACK;
-            graph->nodeLists[temp]->finalizedTime = ++-----globalTimer;
+            graph->nodeLists[temp]->finalizedTime = ++globalTimer;
             stack.pop();
 
             o->count(3);
@@ -168,7 +169,8 @@ void DFS(GraphT *graph, int sourceNode, Operation *o)
 }
 
 // in case the graph is not connected
-void unconnectedDFS(GraphT *graph, Operation *o)
+template <typename Counter>
+void unconnectedDFS(GraphT *graph, Counter *o)
 {
     initializeGraph(graph);
     globalTimer = 0;
@@ -332,15 +334,16 @@ void tarjanSCC(GraphT *graph)
     cout << "\n";
 }
 
+// the graph is allocated with new, so that the adjacency lists are constructed (and destroyed here)
 void freeGraph(GraphT *graph)
 {
     for (int i = 0; i < graph->nrVertices; i++)
     {
-        free(graph->nodeLists[i]);
+        delete graph->nodeLists[i];
     }
 
-    free(graph->nodeLists);
-    free(graph);
+    delete[] graph->nodeLists;
+    delete graph;
 }
 
 void averageCase()
@@ -348,7 +351,7 @@ void averageCase()
     for (int nrEdges = 1000; nrEdges <= 5000; nrEdges += 100)
     {
         const int nrVertices = 100;
-        Operation o = profiler.createOperation("nrOpsFixedVertices", nrEdges);
+        DefaultOperation o = profiler.createCounter<DefaultOperation>("nrOpsFixedVertices", nrEdges);
 
         GraphT *graph = generateRandomGraph(nrVertices, nrEdges);
         unconnectedDFS(graph, &o);
@@ -361,7 +364,7 @@ void averageCase()
     for (int nrVertices = 100; nrVertices <= 200; nrVertices += 10)
     {
         const int nrEdges = 9000;
-        Operation o = profiler.createOperation("nrOpsFixedEdges", nrVertices);
+        DefaultOperation o = profiler.createCounter<DefaultOperation>("nrOpsFixedEdges", nrVertices);
 
         GraphT *graph = generateRandomGraph(nrVertices, nrEdges);
         unconnectedDFS(graph, &o);
@@ -387,12 +390,14 @@ void printInitialGraph(GraphT *graph)
     }
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 main(int argc, char const *argv[])
 {
     srand(time(NULL));
 
     const int nrVertices = 10, nrEdges = 10;
-    Operation o = profiler.createOperation("demo", nrVertices + nrEdges);
+    DefaultOperation o = profiler.createCounter<DefaultOperation>("demo", nrVertices + nrEdges);
 
     GraphT *newGraph = generateRandomGraph(nrVertices, nrEdges);
     initializeGraph(newGraph);
@@ -405,4 +410,5 @@ main(int argc, char const *argv[])
     /* averageCase(); */
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
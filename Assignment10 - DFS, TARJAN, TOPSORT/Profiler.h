@@ -13,17 +13,51 @@
 #   include <Shellapi.h>
 #endif
 
+#ifdef __linux__
+#   include <unistd.h>
+#   include <malloc.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <sys/mman.h>
+#   include <sched.h>
+#   include <linux/perf_event.h>
+#endif
+
+#ifdef _MSC_VER
+#   include <malloc.h>
+#elif defined(__APPLE__)
+#   include <malloc/malloc.h>
+#endif
+
+#ifndef _MSC_VER
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <math.h>
 
 #include <typeinfo>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <string>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <initializer_list>
 
 namespace HtmlGen{
 const char htmlFirst[] = {
@@ -10963,8 +10997,31 @@ const char htmlFirst[] = {
 };
 
 const char htmlLast[] = {
-0x0a, 0x09, 0x76, 0x61, 0x72, 0x20, 0x62, 0x6f, 0x64, 0x79, 0x20, 0x3d, 0x20, 0x24, 0x28, 0x27, 
-0x62, 0x6f, 0x64, 0x79, 0x27, 0x29, 0x3b, 0x0a, 0x09, 0x0a, 0x09, 0x66, 0x6f, 0x72, 0x28, 0x76, 
+0x0a, 0x09, 0x66, 0x6f, 0x72, 0x28, 0x76, 0x61, 0x72, 0x20, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6f, 
+0x6e, 0x20, 0x69, 0x6e, 0x20, 0x64, 0x61, 0x74, 0x61, 0x5b, 0x22, 0x73, 0x65, 0x63, 0x74, 0x69, 
+0x6f, 0x6e, 0x73, 0x22, 0x5d, 0x29, 0x7b, 0x0a, 0x09, 0x09, 0x53, 0x45, 0x43, 0x54, 0x49, 0x4f, 
+0x4e, 0x53, 0x5b, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5d, 0x20, 0x3d, 0x20, 0x64, 0x61, 
+0x74, 0x61, 0x5b, 0x22, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x73, 0x22, 0x5d, 0x5b, 0x73, 
+0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x5d, 0x3b, 0x0a, 0x09, 0x7d, 0x0a, 0x0a, 0x09, 0x76, 0x61, 
+0x72, 0x20, 0x62, 0x6f, 0x64, 0x79, 0x20, 0x3d, 0x20, 0x24, 0x28, 0x27, 0x62, 0x6f, 0x64, 0x79, 
+0x27, 0x29, 0x3b, 0x0a, 0x0a, 0x09, 0x69, 0x66, 0x28, 0x21, 0x69, 0x73, 0x45, 0x6d, 0x70, 0x74, 
+0x79, 0x28, 0x64, 0x61, 0x74, 0x61, 0x5b, 0x22, 0x65, 0x6e, 0x76, 0x69, 0x72, 0x6f, 0x6e, 0x6d, 
+0x65, 0x6e, 0x74, 0x22, 0x5d, 0x29, 0x29, 0x7b, 0x0a, 0x09, 0x09, 0x76, 0x61, 0x72, 0x20, 0x74, 
+0x61, 0x62, 0x6c, 0x65, 0x20, 0x3d, 0x20, 0x22, 0x3c, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x63, 
+0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x67, 0x72, 0x69, 0x64, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x27, 
+0x3e, 0x22, 0x3b, 0x0a, 0x09, 0x09, 0x66, 0x6f, 0x72, 0x28, 0x76, 0x61, 0x72, 0x20, 0x6b, 0x65, 
+0x79, 0x20, 0x69, 0x6e, 0x20, 0x64, 0x61, 0x74, 0x61, 0x5b, 0x22, 0x65, 0x6e, 0x76, 0x69, 0x72, 
+0x6f, 0x6e, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x5d, 0x29, 0x7b, 0x0a, 0x09, 0x09, 0x09, 0x74, 0x61, 
+0x62, 0x6c, 0x65, 0x20, 0x2b, 0x3d, 0x20, 0x22, 0x3c, 0x74, 0x72, 0x3e, 0x3c, 0x74, 0x68, 0x3e, 
+0x22, 0x20, 0x2b, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x68, 0x3e, 
+0x3c, 0x74, 0x64, 0x3e, 0x22, 0x20, 0x2b, 0x20, 0x64, 0x61, 0x74, 0x61, 0x5b, 0x22, 0x65, 0x6e, 
+0x76, 0x69, 0x72, 0x6f, 0x6e, 0x6d, 0x65, 0x6e, 0x74, 0x22, 0x5d, 0x5b, 0x6b, 0x65, 0x79, 0x5d, 
+0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x64, 0x3e, 0x3c, 0x2f, 0x74, 0x72, 0x3e, 0x22, 0x3b, 
+0x0a, 0x09, 0x09, 0x7d, 0x0a, 0x09, 0x09, 0x62, 0x6f, 0x64, 0x79, 0x2e, 0x61, 0x70, 0x70, 0x65, 
+0x6e, 0x64, 0x28, 0x22, 0x3c, 0x68, 0x31, 0x3e, 0x45, 0x6e, 0x76, 0x69, 0x72, 0x6f, 0x6e, 0x6d, 
+0x65, 0x6e, 0x74, 0x3c, 0x2f, 0x68, 0x31, 0x3e, 0x5c, 0x6e, 0x22, 0x20, 0x2b, 0x20, 0x74, 0x61, 
+0x62, 0x6c, 0x65, 0x20, 0x2b, 0x20, 0x22, 0x3c, 0x2f, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x3e, 0x5c, 
+0x6e, 0x22, 0x29, 0x3b, 0x0a, 0x09, 0x7d, 0x0a, 0x09, 0x0a, 0x09, 0x66, 0x6f, 0x72, 0x28, 0x76, 
 0x61, 0x72, 0x20, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x69, 0x6e, 0x20, 0x53, 0x45, 
 0x43, 0x54, 0x49, 0x4f, 0x4e, 0x53, 0x29, 0x7b, 0x0a, 0x09, 0x09, 0x69, 0x66, 0x28, 0x21, 0x69, 
 0x73, 0x45, 0x6d, 0x70, 0x74, 0x79, 0x28, 0x64, 0x61, 0x74, 0x61, 0x5b, 0x73, 0x65, 0x63, 0x74, 
@@ -11093,338 +11150,3419 @@ const char htmlLast[] = {
 };
 };
 
-class Profiler{
+/**
+* reads the hardware performance counters of the thread that opened them (Linux perf_event_open).
+* on other platforms, or when the kernel does not allow it, the events are simply not available
+*/
+class HardwareCounters{
 public:
-	/**
-	* maximum lenght for any string that this class should receive
-	*/
-	static const int MAX_NAME_LEN = 128;
+	enum Event { CYCLES = 0, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, NR_EVENTS };
+
+	HardwareCounters(){
+		for(int i=0; i<NR_EVENTS; ++i){
+			fd[i] = -1;
+		}
+	}
+
+	~HardwareCounters(){
+		close();
+	}
 
 	/**
-	* constructs a new profiler with the given title
+	* opens every event that the machine supports, returns false if none could be opened
 	*/
-	Profiler(const char* givenTitle = NULL){
-		reset(givenTitle);
+	bool open(){
+#ifdef __linux__
+		static const unsigned int types[NR_EVENTS] = {
+			PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+		};
+		static const unsigned long long configs[NR_EVENTS] = {
+			PERF_COUNT_HW_CPU_CYCLES,
+			PERF_COUNT_HW_INSTRUCTIONS,
+			PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+			PERF_COUNT_HW_CACHE_MISSES,
+			PERF_COUNT_HW_BRANCH_MISSES
+		};
+		struct perf_event_attr attr;
+		for(int i=0; i<NR_EVENTS; ++i){
+			if(fd[i] >= 0){
+				continue;
+			}
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = types[i];
+			attr.config = configs[i];
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+#endif
+		for(int i=0; i<NR_EVENTS; ++i){
+			if(fd[i] >= 0){
+				return true;
+			}
+		}
+		return false;
 	}
 
-	~Profiler(){
+	void close(){
+		for(int i=0; i<NR_EVENTS; ++i){
+#ifdef __linux__
+			if(fd[i] >= 0){
+				::close(fd[i]);
+			}
+#endif
+			fd[i] = -1;
+		}
 	}
 
-    /**
-    * increases the count for operation name, at the specified size
-    */
-    void reset(const char *newTitle = NULL){
-        if(opcountMap.size() != 0){
-            showReport();
-        }
-        title = newTitle? newTitle: "Title";
-        groups.clear();
-        opcountMap.clear();
-    }
+	bool isOpen(int event) const{
+		return fd[event] >= 0;
+	}
 
 	/**
-	* increases the count for operation name, at the specified size
+	* reads the current value of every event, the unavailable ones are read as 0
 	*/
-	void countOperation(const char *name, int size, int increment=1){
-		opcountMap[name][size] += increment;
+	void read(unsigned long long values[NR_EVENTS]) const{
+		for(int i=0; i<NR_EVENTS; ++i){
+			values[i] = 0;
+#ifdef __linux__
+			if(fd[i] >= 0 && ::read(fd[i], &values[i], sizeof(values[i])) != sizeof(values[i])){
+				values[i] = 0;
+			}
+#endif
+		}
 	}
 
 	/**
-	* creates a new group from the given members
-	* the members will be displayed in the same chart
+	* the key under which the event is stored in the report and its human readable title
 	*/
-	void createGroup(const char *groupName, const char *member1, const char *member2 = NULL,
-						const char *member3 = NULL, const char *member4 = NULL,
-						const char *member5 = NULL, const char *member6 = NULL,
-						const char *member7 = NULL, const char *member8 = NULL,
-						const char *member9 = NULL, const char *member10 = NULL){
-		groups[groupName] = std::vector<std::string>();
-		//this is a bad coding style
-		//kids, don't do this at home
-#define ADD_MEMBER(member) if(member) {groups[groupName].push_back(member);}
-		ADD_MEMBER(member1);
-		ADD_MEMBER(member2);
-		ADD_MEMBER(member3);
-		ADD_MEMBER(member4);
-		ADD_MEMBER(member5);
-		ADD_MEMBER(member6);
-		ADD_MEMBER(member7);
-		ADD_MEMBER(member8);
-		ADD_MEMBER(member9);
-		ADD_MEMBER(member10);
-#undef ADD_MEMBER
+	static const char *sectionName(int event){
+		static const char *names[NR_EVENTS] = {"cycles", "instructions", "l1dMisses", "llcMisses", "branchMisses"};
+		return names[event];
 	}
 
-	/**
-	* creates a new series, by summing the given ones
-	*/
-	void addSeries(const char *newName, const char *series1, const char *series2){
-		if (opcountMap.find(series1) != opcountMap.end() &&
-			opcountMap.find(series2) != opcountMap.end()){
-				OpcountSequence::const_iterator it1, it2;
-				opcountMap[newName] = OpcountSequence();
-				for (it1 = opcountMap[series1].begin(); it1 != opcountMap[series1].end(); ++it1){
-					it2 = opcountMap[series2].find(it1->first);
-					if(it2 != opcountMap[series2].end()){
-						opcountMap[newName][it1->first] = it1->second + it2->second;
-					}else{
-						opcountMap[newName][it1->first] = it1->second;
-					}
-				}
+	static const char *sectionTitle(int event){
+		static const char *titles[NR_EVENTS] = {"CPU cycles", "Instructions retired", "L1 data cache misses",
+												"Last level cache misses", "Branch mispredictions"};
+		return titles[event];
+	}
+
+private:
+	int fd[NR_EVENTS];
+
+	HardwareCounters(const HardwareCounters&);
+	HardwareCounters& operator=(const HardwareCounters&);
+};
+
+/**
+* the allocations made through TrackedMalloc and TrackedFree by one thread, while the scope is alive.
+* the scopes of a thread are kept in a list and every allocation is charged to all of them, so nested
+* counters each see the allocations made inside them. a scope must be destroyed by the thread that created it
+*/
+class AllocationScope{
+public:
+	enum Measure { COUNT = 0, BYTES, PEAK_BYTES, NANOSECONDS, NR_MEASURES };
+
+	AllocationScope() : count(0), bytes(0), resident(0), peak(0), nanoseconds(0), previous(NULL) {
+		AllocationScope *&first = current();
+		next = first;
+		if(next){
+			next->previous = this;
 		}
+		first = this;
 	}
 
-    /**
-    * divides the values in a series
-    */
-	void divideValues(const char *series, unsigned int divisor) {
-		if (opcountMap.find(series) != opcountMap.end() && divisor != 0) {
-			OpcountSequence::iterator it;
-			for (it = opcountMap[series].begin(); it != opcountMap[series].end(); ++it) {
-				it->second /= divisor;
-			}
+	~AllocationScope(){
+		if(previous){
+			previous->next = next;
+		}else{
+			current() = next;
+		}
+		if(next){
+			next->previous = previous;
 		}
 	}
 
 	/**
-	* creates and shows the report
+	* the number of allocations, the bytes requested, the most bytes held at once (as reserved by the
+	* allocator, counted from the creation of the scope) and the nanoseconds spent in malloc and free
 	*/
-	int showReport(){
-		FILE *fout = NULL;
-		bool hasData, hasSequences;
-		char reportName[200];
-		time_t crtTime = time(0);
-		struct tm now;
-#ifdef _MSC_VER
-		localtime_s(&now, &crtTime);
-#else
-        now = *localtime(&crtTime);
-#endif
+	void read(unsigned long long values[NR_MEASURES]) const{
+		values[COUNT] = count;
+		values[BYTES] = bytes;
+		values[PEAK_BYTES] = (unsigned long long)peak;
+		values[NANOSECONDS] = nanoseconds;
+	}
 
-#ifdef _MSC_VER
-		_snprintf_s(
-#else
-        snprintf(
-#endif
-                            reportName, sizeof(reportName), 
-                            "report-%s-%04d%02d%02d-%02d%02d%02d.html", 
-							title.c_str(),
-							now.tm_year + 1900,
-							now.tm_mon + 1,
-							now.tm_mday,
-							now.tm_hour,
-							now.tm_min,
-							now.tm_sec
-		);
-#ifdef _MSC_VER
-		fopen_s(&fout, reportName, "wb");
-#else
-		fout = fopen(reportName, "wb");
-#endif
-		fwrite(HtmlGen::htmlFirst, 1, sizeof(HtmlGen::htmlFirst)/sizeof(HtmlGen::htmlFirst[0]), fout);
+	static bool active(){
+		return current() != NULL;
+	}
 
-		//first, show the operation counters
-		fprintf(fout, "{\n\t\"opcount\": {\n");
-		OpcountMap::const_iterator oit1;
-		OpcountSequence::const_iterator oit2;
-		hasSequences = false;
-		for(oit1 = opcountMap.begin(); oit1 != opcountMap.end(); ++oit1){
-			hasSequences = true;
-			hasData = false;
-			fprintf(fout, "\t\t\"");
-			print_modified(fout, oit1->first.c_str());
-			fprintf(fout, "\": [");
-			for(oit2 = oit1->second.begin(); oit2 != oit1->second.end(); ++oit2){
-				hasData = true;
-				fprintf(fout, "[%d, %u], ", oit2->first, oit2->second);
-			}
-			if(hasData){
-				fseek(fout, -2, SEEK_CUR);
-			}
-			fprintf(fout, "],\n");
-		}
-		if(hasSequences){
-			fseek(fout, -(int)(strlen("\n") + 1), SEEK_CUR);
-			fprintf(fout, "\n");
-		}
-		
-        fprintf(fout, "\t},\n\t\"groups\": {\n");
-		//next show the groups
-		hasSequences = false;
-		GroupMap::const_iterator git1;
-		std::vector<std::string>::const_iterator git2;
-		for(git1 = groups.begin(); git1 != groups.end(); ++git1){
-			hasSequences = true;
-			hasData = false;
-			fprintf(fout, "\t\t\"");
-			print_modified(fout, git1->first.c_str());
-			fprintf(fout, "\": [");
-			for(git2 = git1->second.begin(); git2 != git1->second.end(); ++git2){
-				hasData = true;
-				fprintf(fout, "\"");
-				print_modified(fout, git2->c_str());
-				fprintf(fout, "\", ");
-			}
-			if(hasData){
-				fseek(fout, -2, SEEK_CUR);
-			}
-			fprintf(fout, "],\n");
+	static void recordAllocation(size_t requested, size_t reserved, unsigned long long elapsed){
+		for(AllocationScope *scope = current(); scope; scope = scope->next){
+			++scope->count;
+			scope->bytes += requested;
+			scope->resident += (long long)reserved;
+			scope->peak = std::max(scope->peak, scope->resident);
+			scope->nanoseconds += elapsed;
 		}
-		if(hasSequences){
-			fseek(fout, -(int)(strlen("\n") + 1), SEEK_CUR);
-			fprintf(fout, "\n");
+	}
+
+	static void recordFree(size_t reserved, unsigned long long elapsed){
+		// memory allocated before the scope and freed inside it takes the resident bytes below 0
+		for(AllocationScope *scope = current(); scope; scope = scope->next){
+			scope->resident -= (long long)reserved;
+			scope->nanoseconds += elapsed;
 		}
-		fprintf(fout, "\t}\n}\n");
-		fwrite(HtmlGen::htmlLast, 1, sizeof(HtmlGen::htmlLast)/sizeof(HtmlGen::htmlLast[0]), fout);
-		fclose(fout);
+	}
 
-#ifdef _MSC_VER
-		ShellExecuteA(NULL, "open", reportName, NULL, NULL, SW_SHOW);
-#endif
+	/**
+	* the bytes the allocator reserved for the block, 0 where that cannot be asked
+	*/
+	static size_t reservedSize(void *ptr){
+#if defined(_MSC_VER)
+		return _msize(ptr);
+#elif defined(__APPLE__)
+		return malloc_size(ptr);
+#elif defined(__linux__)
+		return malloc_usable_size(ptr);
+#else
 		return 0;
+#endif
 	}
 
-private:
-	typedef unsigned int OPCOUNT_MEASURE;
-
-	typedef std::map<int, OPCOUNT_MEASURE> OpcountSequence;
-	typedef std::map<std::string, OpcountSequence> OpcountMap;
-
-	typedef std::map<std::string, std::vector<std::string> > GroupMap;
+	/**
+	* the key under which the measure is stored in the report and its human readable title
+	*/
+	static const char *sectionName(int measure){
+		static const char *names[NR_MEASURES] = {"allocations", "allocatedBytes", "peakBytes", "allocatorTime"};
+		return names[measure];
+	}
 
-public:
-	class OperationCounter{
-		OpcountSequence::iterator ptrInMap;
-		Profiler &profiler;
-		friend class Profiler;
-		OperationCounter(Profiler &prof, const char *name, int size) : profiler(prof) {
-			profiler.opcountMap[name][size]; // force creation
-			ptrInMap = profiler.opcountMap[name].find(size);
-		}
-	  public:
-		void count(int increment=1) { ptrInMap->second += increment; }
-		int get() const { return ptrInMap->second; }
-	};
-	
-	OperationCounter createOperation(const char *name, int size) {
-		return OperationCounter(*this, name, size);
+	static const char *sectionTitle(int measure){
+		static const char *titles[NR_MEASURES] = {"Allocations", "Allocated bytes", "Peak allocated bytes",
+												  "Time in the allocator (ns)"};
+		return titles[measure];
 	}
 
 private:
-	std::string title;
-	OpcountMap opcountMap;
-	GroupMap groups;
+	unsigned long long count, bytes;
+	long long resident, peak;
+	unsigned long long nanoseconds;
+	AllocationScope *previous, *next;
 
-	void print_modified(FILE *f, const char *str){
-		int i = 0;
-		while(str[i] != 0){
-			if(isalnum(str[i]) || str[i] == '_'){
-				fprintf(f, "%c", str[i]);
-			}else{
-				fprintf(f, "_");
-			}
-			++i;
-		}
+	static AllocationScope *&current(){
+		static thread_local AllocationScope *first = NULL;
+		return first;
 	}
+
+	AllocationScope(const AllocationScope&);
+	AllocationScope& operator=(const AllocationScope&);
 };
 
-typedef Profiler::OperationCounter Operation;
+/**
+* malloc, charged to the allocation scopes of the calling thread. without a scope it is only malloc
+*/
+inline void *TrackedMalloc(size_t size){
+	if(!AllocationScope::active()){
+		return malloc(size);
+	}
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	void *ptr = malloc(size);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	if(ptr){
+		AllocationScope::recordAllocation(size, AllocationScope::reservedSize(ptr),
+										  std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+	return ptr;
+}
 
-enum SortMethod { UNSORTED=0, ASCENDING=1, DESCENDING=2 };
 /**
-* fills the given array with random elements in the given range.
-* optionally, the array can be unique or sorted in ascending (1) or descending (2) order
+* free, charged to the allocation scopes of the calling thread. the block may also come from a plain malloc,
+* and a block from TrackedMalloc may also be given to a plain free (it is then never counted as released)
 */
-template <typename T>
-	void FillRandomArray(T *arr, int size, T range_min=10, T range_max=50000, bool unique = false, int sorted=UNSORTED){
-		int i, pos, extendedSize;
-		bool discreteType = true;
-		T interval_len = range_max - range_min + 1;
-		int idx1, idx2;
-		T aux;
-		static bool seeded = false;
+inline void TrackedFree(void *ptr){
+	if(!ptr || !AllocationScope::active()){
+		free(ptr);
+		return;
+	}
+	size_t reserved = AllocationScope::reservedSize(ptr);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	free(ptr);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	AllocationScope::recordFree(reserved, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
 
-		if(!seeded){
-			srand((unsigned int)time(NULL));
-			seeded = true;
-		}
+/**
+* a deterministic model of a hierarchy of set associative LRU caches. every access looks up the lines it touches
+* in the first level, a miss goes on to the next level, and the line is brought into every level that missed it.
+* reads and writes are treated alike (the caches allocate on write), so only the misses of each level are counted.
+* the simulators that are attached to a thread receive the accesses of the SimulatedArray and SimulatedPointer
+* wrappers used by that thread
+*/
+class CacheSimulator{
+public:
+	static const int MAX_LEVELS = 3;
+	enum Measure { ACCESSES = 0, L1_MISSES, L2_MISSES, L3_MISSES, NR_MEASURES };
 
-		if(range_min >= range_max){
-			throw "empty range";
-		}
-		
-		if(typeid(T) == typeid(double) || typeid(T) == typeid(float)){
-			discreteType = false;
+	CacheSimulator() : nrLevels(0), accesses(0) {}
+
+	/**
+	* L1 32 KiB 8 way, L2 1 MiB 16 way, L3 8 MiB 16 way, with 64 byte lines
+	*/
+	static CacheSimulator typical(){
+		CacheSimulator cache;
+		cache.addLevel(32 << 10, 8);
+		cache.addLevel(1 << 20, 16);
+		cache.addLevel(8 << 20, 16);
+		return cache;
+	}
+
+	/**
+	* adds the next level of the hierarchy, all of them start empty
+	*/
+	void addLevel(size_t capacity, int associativity, int lineSize = 64){
+		if(nrLevels == MAX_LEVELS){
+			throw "at most 3 cache levels are simulated";
 		}
-		if(!unique){
-			//no worries
-			for(i=0; i<size; ++i){
-				if(discreteType){
-					arr[i] = range_min + (rand() % int(interval_len));
-				}else{
-					arr[i] = range_min + ((T)(rand()) / RAND_MAX) * (interval_len - 1);
-				}
-			}
-			if(sorted == ASCENDING){
-				std::sort(arr, arr + size);
-			}else if(sorted == DESCENDING){
-				std::sort(arr, arr + size, std::greater<T>());
-			}
-		}else{
-			//use Knuth approach
-			if(discreteType){
-				if(interval_len < size){
-					throw "range too small";
-				}
-				pos = 0;
-				for(i=0; i<=interval_len && pos<size; ++i){
-					if(rand() % (int(interval_len) - i) < (size - pos)){
-						arr[pos++] = range_min + i;
-					}
-				}
-			}else{
-				//use the same approach as above, pick integers from 0 to 17*size
-				extendedSize = 17 * size;
-				pos = 0;
-				for(i=0; i<=extendedSize && pos<size; ++i){
-					if(rand() % (extendedSize - i) < (size - pos)){
-						arr[pos++] = range_min + ((T)i / extendedSize) * (interval_len - 1);
-					}
-				}
-			}
-			//we got a sorted array in ascending order
-			if(sorted == DESCENDING){
-				std::reverse(arr, arr+size);
-			}else if(sorted == UNSORTED){
-				//we need to scramble the array
-				for(i=0; i<size; ++i){
-					idx1 = rand() % size;
-					idx2 = rand() % size;
-					aux = arr[idx1];
-					arr[idx1] = arr[idx2];
-					arr[idx2] = aux;
-				}
-			}
+		if(associativity < 1 || lineSize < 1 || capacity < (size_t)associativity * lineSize){
+			throw "the cache level cannot hold a single set";
 		}
+		Level &level = levels[nrLevels++];
+		level.lineSize = lineSize;
+		level.associativity = associativity;
+		level.nrSets = capacity / ((size_t)associativity * lineSize);
+		level.lineShift = powerOfTwo(lineSize) ? lineShiftOf(lineSize) : -1;
+		level.setMask = powerOfTwo(level.nrSets) ? level.nrSets - 1 : 0;
+		level.clock = 0;
+		level.misses = 0;
+		level.ways.assign(level.nrSets * associativity, Way());
 	}
 
-template <typename T>
-	void CopyArray(T *dst, T *src, int size) {
-		memcpy(dst, src, size * sizeof(T));
+	int levelCount() const{
+		return nrLevels;
 	}
 
-/**
-* Checks if the given array is sorted or not.
-*/
-template <typename T>
-	bool IsSorted(T *arr, int size){
-		int i;
-		for(i=1; i<size; ++i){
-			if(arr[i] < arr[i-1]){
-				return false;
-			}
+	/**
+	* empties the caches and clears the counts
+	*/
+	void flush(){
+		accesses = 0;
+		for(int i=0; i<nrLevels; ++i){
+			std::fill(levels[i].ways.begin(), levels[i].ways.end(), Way());
+			levels[i].clock = 0;
+			levels[i].misses = 0;
 		}
-		return true;
 	}
 
+	void access(const void *address, size_t bytes){
+		if(nrLevels == 0){
+			return;
+		}
+		++accesses;
+		unsigned long long first = (unsigned long long)(size_t)address, last = first + (bytes ? bytes - 1 : 0);
+		unsigned long long lineSize = levels[0].lineSize;
+		if(first / lineSize == last / lineSize){
+			accessLine(first);
+			return;
+		}
+		for(unsigned long long line = first / lineSize; line <= last / lineSize; ++line){
+			accessLine(line * lineSize);
+		}
+	}
+
+	/**
+	* the number of accesses and the misses of each level (0 for the levels that are not simulated)
+	*/
+	void read(unsigned long long values[NR_MEASURES]) const{
+		values[ACCESSES] = accesses;
+		for(int i=0; i<MAX_LEVELS; ++i){
+			values[L1_MISSES + i] = i < nrLevels ? levels[i].misses : 0;
+		}
+	}
+
+	/**
+	* makes the simulator receive the accesses of the calling thread, until it is detached
+	*/
+	void attach(){
+		attached().push_back(this);
+	}
+
+	void detach(){
+		std::vector<CacheSimulator*> &simulators = attached();
+		simulators.erase(std::remove(simulators.begin(), simulators.end(), this), simulators.end());
+	}
+
+	/**
+	* feeds an access of the calling thread to the simulators attached to it
+	*/
+	static void record(const void *address, size_t bytes){
+		std::vector<CacheSimulator*> &simulators = attached();
+		for(size_t i=0; i<simulators.size(); ++i){
+			simulators[i]->access(address, bytes);
+		}
+	}
+
+	/**
+	* the key under which the measure is stored in the report and its human readable title
+	*/
+	static const char *sectionName(int measure){
+		static const char *names[NR_MEASURES] = {"simulatedAccesses", "simulatedL1Misses", "simulatedL2Misses",
+												 "simulatedL3Misses"};
+		return names[measure];
+	}
+
+	static const char *sectionTitle(int measure){
+		static const char *titles[NR_MEASURES] = {"Simulated memory accesses", "Simulated L1 misses",
+												  "Simulated L2 misses", "Simulated L3 misses"};
+		return titles[measure];
+	}
+
+private:
+	struct Way{
+		unsigned long long line, lastUse;
+		Way() : line(~0ULL), lastUse(0) {}
+	};
+
+	struct Level{
+		int lineSize, associativity;
+		// the shift and the mask replace the divisions when the line size and the number of sets are powers of 2
+		int lineShift;
+		size_t nrSets, setMask;
+		unsigned long long clock, misses;
+		// the ways of every set, one set after the other
+		std::vector<Way> ways;
+	};
+
+	Level levels[MAX_LEVELS];
+	int nrLevels;
+	unsigned long long accesses;
+
+	void accessLine(unsigned long long address){
+		for(int i=0; i<nrLevels; ++i){
+			Level &level = levels[i];
+			unsigned long long line = level.lineShift >= 0 ? address >> level.lineShift : address / level.lineSize;
+			size_t set = level.setMask ? (size_t)line & level.setMask : (size_t)(line % level.nrSets);
+			Way *ways = &level.ways[set * level.associativity], *victim = ways;
+			++level.clock;
+			for(int way=0; way<level.associativity; ++way){
+				if(ways[way].line == line){
+					ways[way].lastUse = level.clock;
+					return;
+				}
+				if(ways[way].lastUse < victim->lastUse){
+					victim = &ways[way];
+				}
+			}
+			++level.misses;
+			victim->line = line;
+			victim->lastUse = level.clock;
+		}
+	}
+
+	static bool powerOfTwo(size_t value){
+		return (value & (value - 1)) == 0;
+	}
+
+	static int lineShiftOf(size_t value){
+		int bits = 0;
+		while(value > 1){
+			value >>= 1;
+			++bits;
+		}
+		return bits;
+	}
+
+	static std::vector<CacheSimulator*> &attached(){
+		static thread_local std::vector<CacheSimulator*> simulators;
+		return simulators;
+	}
+};
+
+/**
+* an array whose element accesses are fed to the cache simulators of the thread. it is used where the algorithm
+* takes an int *, reads and writes go through the reference that operator[] returns
+*/
+template <typename T>
+class SimulatedArray{
+public:
+	SimulatedArray(T *givenData) : data(givenData) {}
+
+	T &operator[](long long index) const{
+		CacheSimulator::record(data + index, sizeof(T));
+		return data[index];
+	}
+
+	SimulatedArray operator+(long long offset) const{
+		return SimulatedArray(data + offset);
+	}
+
+	T *get() const{
+		return data;
+	}
+
+private:
+	T *data;
+};
+
+/**
+* a pointer whose dereferences are fed to the cache simulators of the thread, as accesses to the whole object.
+* it converts to and from the plain pointer, so the links of a structure can stay plain pointers
+*/
+template <typename T>
+class SimulatedPointer{
+public:
+	SimulatedPointer(T *givenPointer = NULL) : pointer(givenPointer) {}
+
+	T *operator->() const{
+		CacheSimulator::record(pointer, sizeof(T));
+		return pointer;
+	}
+
+	T &operator*() const{
+		CacheSimulator::record(pointer, sizeof(T));
+		return *pointer;
+	}
+
+	operator T*() const{
+		return pointer;
+	}
+
+private:
+	T *pointer;
+};
+
+/**
+* receives every sample measured by a profiler as soon as it is measured (a counter that is destroyed,
+* a timer that stops), so that long runs can be written out without keeping the samples in memory.
+* the samples are raw: averaging the repetitions of a size is left to whoever reads them
+*/
+class ReportWriter{
+public:
+	virtual ~ReportWriter() {}
+
+	/**
+	* a profiler run starts on construction and on every reset
+	*/
+	virtual void beginRun(const char *title) = 0;
+
+	/**
+	* series identifies the name inside the current run, so that it does not have to be written every time
+	*/
+	virtual void sample(int series, const char *name, const char *section, int size, unsigned long long value) = 0;
+
+	/**
+	* a property of the machine the run is measured on (see Profiler::describeEnvironment), after beginRun
+	*/
+	virtual void environment(const char *, const char *) {}
+
+	virtual void flush() = 0;
+};
+
+/**
+* base of the writers that stream to a file
+*/
+class FileReportWriter : public ReportWriter{
+public:
+	FileReportWriter(const char *fileName, const char *mode){
+#ifdef _MSC_VER
+		fopen_s(&fout, fileName, mode);
+#else
+		fout = fopen(fileName, mode);
+#endif
+		if(!fout){
+			throw "could not open the report file";
+		}
+		setvbuf(fout, NULL, _IOFBF, 1 << 16);
+	}
+
+	~FileReportWriter(){
+		fclose(fout);
+	}
+
+	void flush(){
+		fflush(fout);
+	}
+
+protected:
+	FILE *fout;
+
+	/**
+	* writes str as the inside of a double quoted string, escaping what needs to be escaped in both CSV and JSON
+	*/
+	void printQuoted(const char *str, bool json){
+		for(int i=0; str[i] != 0; ++i){
+			if(str[i] == '"'){
+				fprintf(fout, json ? "\\\"" : "\"\"");
+			}else if(json && (str[i] == '\\' || (unsigned char)str[i] < 0x20)){
+				fprintf(fout, "\\u%04x", (unsigned char)str[i]);
+			}else{
+				fputc(str[i], fout);
+			}
+		}
+	}
+
+private:
+	FileReportWriter(const FileReportWriter&);
+	FileReportWriter& operator=(const FileReportWriter&);
+};
+
+/**
+* one line per sample: run,series,section,size,value
+*/
+class CsvReportWriter : public FileReportWriter{
+public:
+	CsvReportWriter(const char *fileName) : FileReportWriter(fileName, "w"){
+		fprintf(fout, "run,series,section,size,value\n");
+	}
+
+	void beginRun(const char *title){
+		run = title;
+	}
+
+	void sample(int, const char *name, const char *section, int size, unsigned long long value){
+		fputc('"', fout);
+		printQuoted(run.c_str(), false);
+		fprintf(fout, "\",\"");
+		printQuoted(name, false);
+		fprintf(fout, "\",%s,%d,%llu\n", section, size, value);
+	}
+
+private:
+	std::string run;
+};
+
+/**
+* one JSON object per line: {"run": ..., "series": ..., "section": ..., "size": ..., "value": ...}
+*/
+class JsonLinesReportWriter : public FileReportWriter{
+public:
+	JsonLinesReportWriter(const char *fileName) : FileReportWriter(fileName, "w") {}
+
+	void beginRun(const char *title){
+		run = title;
+	}
+
+	void sample(int, const char *name, const char *section, int size, unsigned long long value){
+		fprintf(fout, "{\"run\": \"");
+		printQuoted(run.c_str(), true);
+		fprintf(fout, "\", \"series\": \"");
+		printQuoted(name, true);
+		fprintf(fout, "\", \"section\": \"%s\", \"size\": %d, \"value\": %llu}\n", section, size, value);
+	}
+
+	void environment(const char *key, const char *value){
+		fprintf(fout, "{\"run\": \"");
+		printQuoted(run.c_str(), true);
+		fprintf(fout, "\", \"environment\": \"");
+		printQuoted(key, true);
+		fprintf(fout, "\", \"value\": \"");
+		printQuoted(value, true);
+		fprintf(fout, "\"}\n");
+	}
+
+private:
+	std::string run;
+};
+
+/**
+* a compact little endian format. the file starts with the magic "PRF1", followed by records,
+* each starting with its type byte:
+*	'R' u16 length, title			a new run, the series ids of the previous run are forgotten
+*	'S' u32 series, u16 length, name	the name of a series id, written before its first sample
+*	'P' u32 series, u8 section length, section, i32 size, u64 value
+*/
+class BinaryReportWriter : public FileReportWriter{
+public:
+	BinaryReportWriter(const char *fileName) : FileReportWriter(fileName, "wb"){
+		fwrite("PRF1", 1, 4, fout);
+	}
+
+	void beginRun(const char *title){
+		declared.clear();
+		fputc('R', fout);
+		writeString(title, 2);
+	}
+
+	void sample(int series, const char *name, const char *section, int size, unsigned long long value){
+		if((size_t)series >= declared.size()){
+			declared.resize(series + 1, false);
+		}
+		if(!declared[series]){
+			declared[series] = true;
+			fputc('S', fout);
+			writeInt((unsigned int)series, 4);
+			writeString(name, 2);
+		}
+		fputc('P', fout);
+		writeInt((unsigned int)series, 4);
+		writeString(section, 1);
+		writeInt((unsigned int)size, 4);
+		writeInt(value, 8);
+	}
+
+private:
+	std::vector<bool> declared;
+
+	void writeInt(unsigned long long value, int bytes){
+		for(int i=0; i<bytes; ++i){
+			fputc((int)((value >> (8 * i)) & 0xff), fout);
+		}
+	}
+
+	void writeString(const char *str, int lengthBytes){
+		size_t len = strlen(str);
+		writeInt(len, lengthBytes);
+		fwrite(str, 1, len, fout);
+	}
+};
+
+class Profiler{
+public:
+	/**
+	* maximum lenght for any string that this class should receive
+	*/
+	static const int MAX_NAME_LEN = 128;
+
+	/**
+	* 64 bits, so that quadratic algorithms on large inputs and nanosecond timers do not overflow
+	*/
+	typedef unsigned long long OPCOUNT_MEASURE;
+
+	/**
+	* the interned name of a series. looking up a series by its id does not hash its name again
+	*/
+	typedef int SeriesId;
+
+	/**
+	* the measures kept for every series. the hardware events follow the times, in the order of HardwareCounters::Event,
+	* the allocations follow the hardware events, in the order of AllocationScope::Measure, and the simulated
+	* cache comes last, in the order of CacheSimulator::Measure
+	*/
+	enum Section { OPCOUNT = 0, TIMES, HARDWARE_EVENTS, ALLOCATIONS = HARDWARE_EVENTS + HardwareCounters::NR_EVENTS,
+				   SIMULATED_CACHE = ALLOCATIONS + AllocationScope::NR_MEASURES,
+				   NR_SECTIONS = SIMULATED_CACHE + CacheSimulator::NR_MEASURES };
+
+	/**
+	* the formats in which the samples can be streamed while the profiler runs
+	*/
+	enum ReportFormat { CSV_REPORT, JSON_LINES_REPORT, BINARY_REPORT };
+
+	/**
+	* constructs a new profiler with the given title
+	*/
+	Profiler(const char* givenTitle = NULL)
+		: generation(0), allocationsTracked(false), cacheSimulated(false), scopesRecorded(false), maxEvents(0),
+		  epoch(std::chrono::steady_clock::now()){
+		reset(givenTitle);
+	}
+
+	~Profiler(){
+		for(size_t i=0; i<writers.size(); ++i){
+			delete writers[i];
+		}
+		for(size_t i=0; i<shardChunks.size(); ++i){
+			free(shardChunks[i]);
+		}
+	}
+
+    /**
+    * increases the count for operation name, at the specified size
+    */
+    void reset(const char *newTitle = NULL){
+        if(series.size() != 0){
+            showReport();
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        title = newTitle? newTitle: "Title";
+        groups.clear();
+        // the counters and timers that are still alive keep running, but nothing is merged anymore
+        detachShards();
+        ++generation;
+        series.clear();
+        seriesIds.clear();
+        sampledPoints.clear();
+        scopeNodes.clear();
+        scopeNodes.push_back(ScopeNode());
+        traceEvents.clear();
+        droppedEvents = 0;
+        for(size_t i=0; i<writers.size(); ++i){
+            writers[i]->beginRun(title.c_str());
+            describeRun(writers[i]);
+        }
+    }
+
+	/**
+	* writes every sample to the given file as soon as it is measured, besides keeping it for the html report
+	*/
+	void streamReport(const char *fileName, ReportFormat format){
+		if(format == CSV_REPORT){
+			addWriter(new CsvReportWriter(fileName));
+		}else if(format == JSON_LINES_REPORT){
+			addWriter(new JsonLinesReportWriter(fileName));
+		}else{
+			addWriter(new BinaryReportWriter(fileName));
+		}
+	}
+
+	/**
+	* streams the samples to a writer of your own, which is deleted together with the profiler
+	*/
+	void addWriter(ReportWriter *writer){
+		std::lock_guard<std::mutex> guard(lock);
+		writers.push_back(writer);
+		writer->beginRun(title.c_str());
+		describeRun(writer);
+	}
+
+	/**
+	* records a property of the machine the benchmark runs on (the cpu governor, the core it is pinned to...),
+	* shown at the top of the report and sent to the writers. the environment is kept across resets
+	*/
+	void describeEnvironment(const char *key, const char *value){
+		std::lock_guard<std::mutex> guard(lock);
+		environment[key] = value;
+		for(size_t i=0; i<writers.size(); ++i){
+			writers[i]->environment(key, value);
+		}
+	}
+
+	/**
+	* enables reading the hardware counters (cycles, instructions, cache and branch misses) in the timers.
+	* only the thread that calls this is counted. returns false if no counter is available on this machine
+	*/
+	bool enableHardwareCounters(){
+		return hardwareCounters.open();
+	}
+
+	/**
+	* makes every operation counter created from now on record the allocations that its thread makes through
+	* TrackedMalloc and TrackedFree while it is alive, into the allocation sections of its series and size
+	*/
+	void trackAllocations(bool enable = true){
+		std::lock_guard<std::mutex> guard(lock);
+		allocationsTracked = enable;
+	}
+
+	/**
+	* makes every operation counter created from now on run its own copy of the cache model, empty at first,
+	* on the accesses that its thread makes through SimulatedArray and SimulatedPointer while it is alive.
+	* the accesses and the misses of each level are added to the simulated cache sections of its series and size
+	*/
+	void simulateCache(const CacheSimulator &model){
+		std::lock_guard<std::mutex> guard(lock);
+		cacheModel = model;
+		cacheModel.flush();
+		cacheSimulated = model.levelCount() > 0;
+	}
+
+	void stopCacheSimulation(){
+		std::lock_guard<std::mutex> guard(lock);
+		cacheSimulated = false;
+	}
+
+	/**
+	* returns the id of the series with the given name, creating the series if needed
+	*/
+	SeriesId seriesId(const char *name){
+		std::lock_guard<std::mutex> guard(lock);
+		return internSeries(name);
+	}
+
+	/**
+	* increases the count for operation name, at the specified size
+	*/
+	void countOperation(const char *name, int size, int increment=1){
+		std::lock_guard<std::mutex> guard(lock);
+		PointRef ref = point(internSeries(name), OPCOUNT, size);
+		ref.column->values[ref.point] += increment;
+		writeSample(ref, increment);
+	}
+
+	/**
+	* creates a new group from the given members
+	* the members will be displayed in the same chart
+	*/
+	void createGroup(const char *groupName, const char *member1, const char *member2 = NULL,
+						const char *member3 = NULL, const char *member4 = NULL,
+						const char *member5 = NULL, const char *member6 = NULL,
+						const char *member7 = NULL, const char *member8 = NULL,
+						const char *member9 = NULL, const char *member10 = NULL){
+		std::lock_guard<std::mutex> guard(lock);
+		groups[groupName] = std::vector<std::string>();
+		//this is a bad coding style
+		//kids, don't do this at home
+#define ADD_MEMBER(member) if(member) {groups[groupName].push_back(member);}
+		ADD_MEMBER(member1);
+		ADD_MEMBER(member2);
+		ADD_MEMBER(member3);
+		ADD_MEMBER(member4);
+		ADD_MEMBER(member5);
+		ADD_MEMBER(member6);
+		ADD_MEMBER(member7);
+		ADD_MEMBER(member8);
+		ADD_MEMBER(member9);
+		ADD_MEMBER(member10);
+#undef ADD_MEMBER
+	}
+
+	/**
+	* creates a new series, by summing the given ones
+	*/
+	void addSeries(const char *newName, const char *series1, const char *series2){
+		std::lock_guard<std::mutex> guard(lock);
+		mergeShards();
+		std::unordered_map<std::string, SeriesId>::const_iterator it1 = seriesIds.find(series1), it2 = seriesIds.find(series2);
+		if(it1 == seriesIds.end() || it2 == seriesIds.end()){
+			return;
+		}
+		SeriesId id1 = it1->second, id2 = it2->second, newId = internSeries(newName);
+		for(int section=0; section<NR_SECTIONS; ++section){
+			const Column &column1 = series[id1].columns[section];
+			Column &column2 = series[id2].columns[section];
+			if(column1.sizes.empty() || column2.sizes.empty()){
+				continue;
+			}
+			Column sum;
+			for(size_t i=0; i<column1.sizes.size(); ++i){
+				size_t point = pointIndex(column2, column1.sizes[i], false);
+				sum.values[pointIndex(sum, column1.sizes[i], true)] =
+					column1.values[i] + (point != NO_POINT ? column2.values[point] : 0);
+			}
+			series[newId].columns[section] = sum;
+		}
+	}
+
+	/**
+	* the statistics of the samples of one point
+	*/
+	struct Statistics{
+		std::vector<OPCOUNT_MEASURE> samples;
+		double mean, median, p95, p99, stddev;
+	};
+
+	/**
+	* starts keeping every sample of the given point, in every section, instead of only their sum
+	*/
+	void keepSamples(SeriesId id, int size){
+		std::lock_guard<std::mutex> guard(lock);
+		sampledPoints[std::make_pair(id, size)];
+	}
+
+	/**
+	* computes the statistics of the samples kept for a point. returns false if the point has no samples in the section
+	*/
+	bool sampleStatistics(SeriesId id, int size, int section, Statistics &stats){
+		std::lock_guard<std::mutex> guard(lock);
+		SampleMap::const_iterator it = sampledPoints.find(std::make_pair(id, size));
+		if(it == sampledPoints.end() || it->second.values[section].empty()){
+			return false;
+		}
+		computeStatistics(it->second.values[section], stats);
+		return true;
+	}
+
+	/**
+	* replaces the sums of a sampled point with the mean of its samples and adds the median, p95, p99 and
+	* standard deviation of the samples as the series name_median, name_p95, name_p99 and name_stddev.
+	* the samples are no longer kept afterwards
+	*/
+	void summarizeSamples(SeriesId id, int size){
+		std::lock_guard<std::mutex> guard(lock);
+		SampleMap::iterator it = sampledPoints.find(std::make_pair(id, size));
+		if(it == sampledPoints.end()){
+			return;
+		}
+		static const char *suffixes[] = {"_median", "_p95", "_p99", "_stddev"};
+		Statistics stats;
+		for(int section=0; section<NR_SECTIONS; ++section){
+			if(it->second.values[section].empty()){
+				continue;
+			}
+			computeStatistics(it->second.values[section], stats);
+			double summary[] = {stats.median, stats.p95, stats.p99, stats.stddev};
+			PointRef ref = point(id, section, size);
+			ref.column->values[ref.point] = (OPCOUNT_MEASURE)(stats.mean + 0.5);
+			for(int i=0; i<4; ++i){
+				ref = point(internSeries((series[id].name + suffixes[i]).c_str()), section, size);
+				ref.column->values[ref.point] = (OPCOUNT_MEASURE)(summary[i] + 0.5);
+			}
+		}
+		sampledPoints.erase(it);
+	}
+
+    /**
+    * divides the values in a series
+    */
+	void divideValues(const char *name, unsigned int divisor) {
+		std::lock_guard<std::mutex> guard(lock);
+		mergeShards();
+		std::unordered_map<std::string, SeriesId>::const_iterator it = seriesIds.find(name);
+		if (it == seriesIds.end() || divisor == 0) {
+			return;
+		}
+		for(int section=0; section<NR_SECTIONS; ++section){
+			std::vector<OPCOUNT_MEASURE> &values = series[it->second].columns[section].values;
+			for (size_t i=0; i<values.size(); ++i) {
+				values[i] /= divisor;
+			}
+		}
+	}
+
+	/**
+	* copies the points of a series in a section, sorted by size. returns false if the series has no points there
+	*/
+	bool seriesPoints(const char *name, int section, std::vector<int> &sizes, std::vector<OPCOUNT_MEASURE> &values){
+		std::lock_guard<std::mutex> guard(lock);
+		mergeShards();
+		std::unordered_map<std::string, SeriesId>::const_iterator it = seriesIds.find(name);
+		if(it == seriesIds.end() || series[it->second].columns[section].sizes.empty()){
+			return false;
+		}
+		const Column &column = series[it->second].columns[section];
+		std::vector<size_t> order;
+		sortedPoints(column, order);
+		sizes.resize(order.size());
+		values.resize(order.size());
+		for(size_t i=0; i<order.size(); ++i){
+			sizes[i] = column.sizes[order[i]];
+			values[i] = column.values[order[i]];
+		}
+		return true;
+	}
+
+	/**
+	* the names of all the series, in the order in which they were created
+	*/
+	std::vector<std::string> seriesNames(){
+		std::lock_guard<std::mutex> guard(lock);
+		std::vector<std::string> names;
+		for(size_t i=0; i<series.size(); ++i){
+			names.push_back(series[i].name);
+		}
+		return names;
+	}
+
+	/**
+	* creates and shows the report
+	*/
+	int showReport(){
+		FILE *fout = NULL;
+		bool hasData, hasSequences;
+		char reportName[200];
+		time_t crtTime = time(0);
+		struct tm now;
+		std::lock_guard<std::mutex> guard(lock);
+		mergeShards();
+#ifdef _MSC_VER
+		localtime_s(&now, &crtTime);
+#else
+        now = *localtime(&crtTime);
+#endif
+
+#ifdef _MSC_VER
+		_snprintf_s(
+#else
+        snprintf(
+#endif
+                            reportName, sizeof(reportName), 
+                            "report-%s-%04d%02d%02d-%02d%02d%02d.html", 
+							title.c_str(),
+							now.tm_year + 1900,
+							now.tm_mon + 1,
+							now.tm_mday,
+							now.tm_hour,
+							now.tm_min,
+							now.tm_sec
+		);
+#ifdef _MSC_VER
+		fopen_s(&fout, reportName, "wb");
+#else
+		fout = fopen(reportName, "wb");
+#endif
+		fwrite(HtmlGen::htmlFirst, 1, sizeof(HtmlGen::htmlFirst)/sizeof(HtmlGen::htmlFirst[0]), fout);
+
+		//first, show the operation counters, then the timers and the hardware counters
+		fprintf(fout, "{\n");
+		for(int section=0; section<NR_SECTIONS; ++section){
+			printSection(fout, section);
+		}
+
+		//the sections besides opcount and times need a title in the report
+		fprintf(fout, "\t\"sections\": {");
+		for(int section=HARDWARE_EVENTS; section<NR_SECTIONS; ++section){
+			fprintf(fout, "%s\"%s\": \"%s\"", section == HARDWARE_EVENTS ? "" : ", ",
+					sectionName(section), sectionTitle(section));
+		}
+		fprintf(fout, "},\n");
+
+		fprintf(fout, "\t\"environment\": {");
+		std::map<std::string, std::string>::const_iterator eit;
+		for(eit = environment.begin(); eit != environment.end(); ++eit){
+			fprintf(fout, eit == environment.begin() ? "\"" : ", \"");
+			printJsonString(fout, eit->first.c_str());
+			fprintf(fout, "\": \"");
+			printJsonString(fout, eit->second.c_str());
+			fprintf(fout, "\"");
+		}
+		fprintf(fout, "},\n");
+
+        fprintf(fout, "\t\"groups\": {\n");
+		//next show the groups
+		hasSequences = false;
+		GroupMap::const_iterator git1;
+		std::vector<std::string>::const_iterator git2;
+		for(git1 = groups.begin(); git1 != groups.end(); ++git1){
+			fprintf(fout, hasSequences ? ",\n\t\t\"" : "\t\t\"");
+			hasSequences = true;
+			hasData = false;
+			print_modified(fout, git1->first.c_str());
+			fprintf(fout, "\": [");
+			for(git2 = git1->second.begin(); git2 != git1->second.end(); ++git2){
+				fprintf(fout, hasData ? ", \"" : "\"");
+				hasData = true;
+				print_modified(fout, git2->c_str());
+				fprintf(fout, "\"");
+			}
+			fprintf(fout, "]");
+		}
+		fprintf(fout, hasSequences ? "\n\t}\n}\n" : "\t}\n}\n");
+		fwrite(HtmlGen::htmlLast, 1, sizeof(HtmlGen::htmlLast)/sizeof(HtmlGen::htmlLast[0]), fout);
+		fclose(fout);
+		for(size_t i=0; i<writers.size(); ++i){
+			writers[i]->flush();
+		}
+
+#ifdef _MSC_VER
+		ShellExecuteA(NULL, "open", reportName, NULL, NULL, SW_SHOW);
+#endif
+		return 0;
+	}
+
+	/**
+	* the key under which a section is stored in the report
+	*/
+	static const char *sectionName(int section){
+		if(section == OPCOUNT){
+			return "opcount";
+		}else if(section == TIMES){
+			return "times";
+		}else if(section >= SIMULATED_CACHE){
+			return CacheSimulator::sectionName(section - SIMULATED_CACHE);
+		}else if(section >= ALLOCATIONS){
+			return AllocationScope::sectionName(section - ALLOCATIONS);
+		}
+		return HardwareCounters::sectionName(section - HARDWARE_EVENTS);
+	}
+
+	/**
+	* the title of a section besides opcount and times in the report
+	*/
+	static const char *sectionTitle(int section){
+		if(section >= SIMULATED_CACHE){
+			return CacheSimulator::sectionTitle(section - SIMULATED_CACHE);
+		}else if(section >= ALLOCATIONS){
+			return AllocationScope::sectionTitle(section - ALLOCATIONS);
+		}
+		return HardwareCounters::sectionTitle(section - HARDWARE_EVENTS);
+	}
+
+private:
+	typedef std::map<std::string, std::vector<std::string> > GroupMap;
+
+	static const size_t NO_POINT = (size_t)-1;
+
+	/**
+	* the points of one series in one section, in the order in which they were created.
+	* a point never moves, so the counters only keep its index
+	*/
+	struct Column{
+		std::vector<int> sizes;
+		std::vector<OPCOUNT_MEASURE> values;
+		// sizes usually come in ascending order and are found by binary search,
+		// the hash index is only built once a size comes out of order
+		bool ascending;
+		std::unordered_map<int, size_t> index;
+		Column() : ascending(true) {}
+	};
+
+	struct Series{
+		std::string name;
+		Column columns[NR_SECTIONS];
+	};
+
+	/**
+	* the samples of a point, for each section
+	*/
+	struct PointSamples{
+		std::vector<OPCOUNT_MEASURE> values[NR_SECTIONS];
+	};
+	typedef std::map<std::pair<SeriesId, int>, PointSamples> SampleMap;
+
+	/**
+	* a point of a series: its column and its index in the column
+	*/
+	struct PointRef{
+		Column *column;
+		size_t point;
+		SeriesId series;
+		int section;
+	};
+
+	static const int CACHE_LINE_SIZE = 64;
+	static const int SHARDS_PER_CHUNK = 64;
+
+	/**
+	* the private slot of one counter. every counter gets its own cache line, so the counters
+	* used by different threads never write to the same line and never need to synchronize.
+	* value is only written by the thread of the counter, with relaxed atomics so that get() and
+	* the reports can read it while that thread counts
+	*/
+	struct CounterShard{
+		PointRef target;
+		// everything counted since the shard was acquired
+		std::atomic<OPCOUNT_MEASURE> value;
+		// the part of the value already added to the series (by a report) or dropped (by a reset), under the lock
+		OPCOUNT_MEASURE merged;
+		bool inUse;
+		char padding[CACHE_LINE_SIZE - sizeof(PointRef) - sizeof(std::atomic<OPCOUNT_MEASURE>) - sizeof(OPCOUNT_MEASURE) - sizeof(bool)];
+	};
+
+public:
+	/**
+	* counts into a shard of its own, which is merged into the series when the counter is destroyed,
+	* on report and on reset. counters can be created from any thread, but a counter must only be used
+	* by one thread at a time (create one per thread for parallel algorithms). get() and the reports can
+	* be called while other threads count, they see the counts made up to then
+	*/
+	class OperationCounter{
+		CounterShard *shard;
+		Profiler *profiler;
+		// only when the profiler tracks allocations or simulates a cache. the counter is moved,
+		// the scope and the simulator must keep their address
+		AllocationScope *allocations;
+		CacheSimulator *cache;
+		friend class Profiler;
+		OperationCounter(Profiler &prof, const char *name, int size) : profiler(&prof), allocations(NULL), cache(NULL) {
+			std::lock_guard<std::mutex> guard(profiler->lock);
+			shard = profiler->acquireShard(profiler->point(profiler->internSeries(name), OPCOUNT, size));
+			attachScopes();
+		}
+		OperationCounter(Profiler &prof, SeriesId id, int size) : profiler(&prof), allocations(NULL), cache(NULL) {
+			std::lock_guard<std::mutex> guard(profiler->lock);
+			shard = profiler->acquireShard(profiler->point(id, OPCOUNT, size));
+			attachScopes();
+		}
+		void attachScopes() {
+			if(profiler->allocationsTracked){
+				allocations = new AllocationScope();
+			}
+			if(profiler->cacheSimulated){
+				cache = new CacheSimulator(profiler->cacheModel);
+				cache->attach();
+			}
+		}
+		OperationCounter(const OperationCounter&);
+		OperationCounter& operator=(const OperationCounter&);
+	  public:
+		OperationCounter(OperationCounter &&other)
+			: shard(other.shard), profiler(other.profiler), allocations(other.allocations), cache(other.cache) {
+			other.profiler = NULL;
+			other.allocations = NULL;
+			other.cache = NULL;
+		}
+		~OperationCounter() {
+			if(cache){
+				cache->detach();
+			}
+			if(profiler){
+				std::lock_guard<std::mutex> guard(profiler->lock);
+				if(allocations){
+					profiler->releaseAllocations(shard, *allocations);
+				}
+				if(cache){
+					profiler->releaseCache(shard, *cache);
+				}
+				profiler->releaseShard(shard);
+			}
+			delete allocations;
+			delete cache;
+		}
+		// only this counter writes the value, a load and a store are enough (and are plain moves on x86)
+		void count(int increment=1) {
+			shard->value.store(shard->value.load(std::memory_order_relaxed) + increment, std::memory_order_relaxed);
+		}
+		/**
+		* the operations counted by this counter alone, without taking the lock
+		*/
+		OPCOUNT_MEASURE counted() const { return shard->value.load(std::memory_order_relaxed); }
+		OPCOUNT_MEASURE get() const {
+			std::lock_guard<std::mutex> guard(profiler->lock);
+			return profiler->pointValue(shard);
+		}
+	};
+	
+	OperationCounter createOperation(const char *name, int size) {
+		return OperationCounter(*this, name, size);
+	}
+
+	/**
+	* same as above, without looking up the name of the series
+	*/
+	OperationCounter createOperation(SeriesId id, int size) {
+		return OperationCounter(*this, id, size);
+	}
+
+	/**
+	* creates a counter of the given counting policy (OperationCounter or NullOperation),
+	* used by the algorithms that are templated on the policy
+	*/
+	template <typename Counter, typename Name>
+	Counter createCounter(Name name, int size) {
+		return Counter(*this, name, size);
+	}
+
+	/**
+	* measures the time (and the hardware counters, if enabled) between its creation and its destruction.
+	* the result is added to the series name at the specified size, next to the operation count of the same name
+	*/
+	class ScopedTimer{
+		PointRef points[NR_SECTIONS];
+		Profiler *profiler;
+		unsigned int generation;
+		unsigned long long countersStart[HardwareCounters::NR_EVENTS];
+		std::chrono::steady_clock::time_point start;
+		friend class Profiler;
+		ScopedTimer(Profiler &prof, const char *name, int size) : profiler(&prof) {
+			{
+				std::lock_guard<std::mutex> guard(profiler->lock);
+				init(profiler->internSeries(name), size);
+			}
+			profiler->hardwareCounters.read(countersStart);
+			// taken last, so that the bookkeeping above is not measured
+			start = std::chrono::steady_clock::now();
+		}
+		ScopedTimer(Profiler &prof, SeriesId id, int size) : profiler(&prof) {
+			{
+				std::lock_guard<std::mutex> guard(profiler->lock);
+				init(id, size);
+			}
+			profiler->hardwareCounters.read(countersStart);
+			start = std::chrono::steady_clock::now();
+		}
+		void init(SeriesId id, int size) {
+			generation = profiler->generation;
+			points[TIMES] = profiler->point(id, TIMES, size);
+			for(int i=0; i<HardwareCounters::NR_EVENTS; ++i){
+				if(profiler->hardwareCounters.isOpen(i)){
+					points[HARDWARE_EVENTS + i] = profiler->point(id, HARDWARE_EVENTS + i, size);
+				}
+			}
+		}
+		ScopedTimer(const ScopedTimer&);
+		ScopedTimer& operator=(const ScopedTimer&);
+	  public:
+		ScopedTimer(ScopedTimer &&other) : profiler(other.profiler), generation(other.generation), start(other.start) {
+			for(int i=0; i<NR_SECTIONS; ++i){
+				points[i] = other.points[i];
+			}
+			for(int i=0; i<HardwareCounters::NR_EVENTS; ++i){
+				countersStart[i] = other.countersStart[i];
+			}
+			other.profiler = NULL;
+		}
+		~ScopedTimer() { stop(); }
+		/**
+		* stops the timer before the end of the scope, a stopped timer is not recorded again
+		*/
+		void stop() {
+			if(!profiler){
+				return;
+			}
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			unsigned long long countersEnd[HardwareCounters::NR_EVENTS];
+			profiler->hardwareCounters.read(countersEnd);
+
+			std::lock_guard<std::mutex> guard(profiler->lock);
+			// the series were cleared by a reset since the timer started
+			if(generation == profiler->generation){
+				OPCOUNT_MEASURE elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+				points[TIMES].column->values[points[TIMES].point] += elapsed;
+				profiler->writeSample(points[TIMES], elapsed);
+				for(int i=0; i<HardwareCounters::NR_EVENTS; ++i){
+					if(profiler->hardwareCounters.isOpen(i)){
+						PointRef &ref = points[HARDWARE_EVENTS + i];
+						ref.column->values[ref.point] += countersEnd[i] - countersStart[i];
+						profiler->writeSample(ref, countersEnd[i] - countersStart[i]);
+					}
+				}
+			}
+			profiler = NULL;
+		}
+	};
+
+	ScopedTimer createTimer(const char *name, int size) {
+		return ScopedTimer(*this, name, size);
+	}
+
+	ScopedTimer createTimer(SeriesId id, int size) {
+		return ScopedTimer(*this, id, size);
+	}
+
+	/**
+	* a named phase of an algorithm, at a size. scopes nest: a scope created while another scope of the same thread
+	* is alive is its child. the time of the scope, and the operations that the counter it is given counts meanwhile,
+	* are added to the call tree of the profiler (see writeFoldedStacks) and the scope is kept as an event of the
+	* trace (see writeChromeTrace). nothing is recorded unless the profiler records scopes.
+	* a scope lives on the stack of its thread and cannot be moved
+	*/
+	class ProfileScope{
+	  public:
+		ProfileScope(Profiler &prof, const char *name, int size) : counter(NULL), readCounter(NULL) {
+			begin(prof, name, size);
+		}
+		template <typename Counter>
+		ProfileScope(Profiler &prof, const char *name, int size, const Counter *givenCounter)
+			: counter(givenCounter), readCounter(&countedBy<Counter>) {
+			begin(prof, name, size);
+		}
+		~ProfileScope() {
+			if(!profiler){
+				return;
+			}
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			OPCOUNT_MEASURE operations = counter ? readCounter(counter) - countStart : 0;
+			current() = parent;
+
+			std::lock_guard<std::mutex> guard(profiler->lock);
+			if(generation == profiler->generation){
+				profiler->recordScope(node, start, end, operations);
+			}
+		}
+	  private:
+		Profiler *profiler;
+		ProfileScope *parent;
+		size_t node;
+		unsigned int generation;
+		const void *counter;
+		OPCOUNT_MEASURE (*readCounter)(const void *counter);
+		OPCOUNT_MEASURE countStart;
+		std::chrono::steady_clock::time_point start;
+
+		void begin(Profiler &prof, const char *name, int size) {
+			profiler = &prof;
+			{
+				std::lock_guard<std::mutex> guard(profiler->lock);
+				if(!profiler->scopesRecorded){
+					profiler = NULL;
+					return;
+				}
+				generation = profiler->generation;
+				parent = current();
+				// a parent of another profiler, or from before a reset, is not in the tree: the scope starts at the root
+				bool nested = parent && parent->profiler == profiler && parent->generation == generation;
+				node = profiler->scopeNode(nested ? parent->node : 0, name, size);
+			}
+			current() = this;
+			countStart = counter ? readCounter(counter) : 0;
+			// taken last, so that the bookkeeping above is not measured
+			start = std::chrono::steady_clock::now();
+		}
+
+		template <typename Counter>
+		static OPCOUNT_MEASURE countedBy(const void *counter) {
+			return ((const Counter*)counter)->counted();
+		}
+
+		static ProfileScope *&current() {
+			static thread_local ProfileScope *scope = NULL;
+			return scope;
+		}
+
+		ProfileScope(const ProfileScope&);
+		ProfileScope& operator=(const ProfileScope&);
+	};
+
+	/**
+	* makes the scopes created from now on record themselves. the trace keeps at most maxTraceEvents scopes,
+	* the call tree keeps all of them
+	*/
+	void recordScopes(bool enable = true, size_t maxTraceEvents = 1000000){
+		std::lock_guard<std::mutex> guard(lock);
+		scopesRecorded = enable;
+		maxEvents = maxTraceEvents;
+	}
+
+	/**
+	* writes the scopes in the trace event format of chrome://tracing and Perfetto, one complete event per scope
+	* with its size and its operations as arguments
+	*/
+	void writeChromeTrace(const char *fileName){
+		FILE *fout = openFile(fileName);
+		std::lock_guard<std::mutex> guard(lock);
+		fprintf(fout, "{\"traceEvents\": [");
+		for(size_t i=0; i<traceEvents.size(); ++i){
+			const TraceEvent &event = traceEvents[i];
+			fprintf(fout, "%s\n{\"name\": \"", i == 0 ? "" : ",");
+			printJsonString(fout, scopeNodes[event.node].name.c_str());
+			fprintf(fout, "\", \"cat\": \"scope\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d, "
+					"\"args\": {\"size\": %d, \"operations\": %llu}}",
+					event.start / 1000.0, event.duration / 1000.0, event.thread, scopeNodes[event.node].size, event.operations);
+		}
+		fprintf(fout, "\n], \"displayTimeUnit\": \"ns\", \"otherData\": {\"title\": \"");
+		printJsonString(fout, title.c_str());
+		fprintf(fout, "\", \"droppedEvents\": %llu}}\n", droppedEvents);
+		fclose(fout);
+	}
+
+	/**
+	* writes the call tree of the scopes in the folded stack format of flamegraph.pl and speedscope: one line
+	* per path of scopes, "root(size);child(size) value", where the value is what the last scope of the path
+	* spent outside of its children, in nanoseconds (TIMES) or in operations (OPCOUNT)
+	*/
+	void writeFoldedStacks(const char *fileName, int section = TIMES){
+		FILE *fout = openFile(fileName);
+		std::lock_guard<std::mutex> guard(lock);
+		std::string path;
+		printFolded(fout, 0, path, section);
+		fclose(fout);
+	}
+
+private:
+	std::string title;
+	// a deque never moves its elements, so the columns keep their address while series are added
+	std::deque<Series> series;
+	std::unordered_map<std::string, SeriesId> seriesIds;
+	unsigned int generation;
+	GroupMap groups;
+	HardwareCounters hardwareCounters;
+	std::vector<char*> shardChunks;
+	std::vector<CounterShard*> freeShards;
+	std::vector<ReportWriter*> writers;
+	SampleMap sampledPoints;
+	bool allocationsTracked;
+	CacheSimulator cacheModel;
+	bool cacheSimulated;
+
+	/**
+	* a node of the call tree of the scopes: the scopes with the same name and size under the same parent
+	*/
+	struct ScopeNode{
+		std::string name;
+		int size;
+		OPCOUNT_MEASURE calls, nanoseconds, operations;
+		std::map<std::pair<std::string, int>, size_t> children;
+		ScopeNode() : size(0), calls(0), nanoseconds(0), operations(0) {}
+	};
+
+	struct TraceEvent{
+		size_t node;
+		// since the creation of the profiler
+		OPCOUNT_MEASURE start, duration, operations;
+		int thread;
+	};
+
+	// the root of the tree is the node 0
+	std::deque<ScopeNode> scopeNodes;
+	std::vector<TraceEvent> traceEvents;
+	bool scopesRecorded;
+	size_t maxEvents;
+	OPCOUNT_MEASURE droppedEvents;
+	std::chrono::steady_clock::time_point epoch;
+	std::map<std::string, std::string> environment;
+	std::mutex lock;
+
+	// the functions below expect the lock to be held
+	SeriesId internSeries(const char *name){
+		std::unordered_map<std::string, SeriesId>::const_iterator it = seriesIds.find(name);
+		if(it != seriesIds.end()){
+			return it->second;
+		}
+		SeriesId id = (SeriesId)series.size();
+		series.push_back(Series());
+		series.back().name = name;
+		seriesIds[name] = id;
+		return id;
+	}
+
+	/**
+	* returns the index of the point with the given size, optionally creating it (with the value 0)
+	*/
+	static size_t pointIndex(Column &column, int size, bool create){
+		size_t n = column.sizes.size();
+		if(n != 0 && column.sizes[n - 1] == size){
+			return n - 1;
+		}
+		if(column.ascending){
+			if(n != 0 && size < column.sizes[n - 1]){
+				std::vector<int>::const_iterator it = std::lower_bound(column.sizes.begin(), column.sizes.end(), size);
+				if(*it == size){
+					return it - column.sizes.begin();
+				}
+				if(!create){
+					return NO_POINT;
+				}
+				column.ascending = false;
+				for(size_t i=0; i<n; ++i){
+					column.index[column.sizes[i]] = i;
+				}
+			}
+		}else{
+			std::unordered_map<int, size_t>::const_iterator it = column.index.find(size);
+			if(it != column.index.end()){
+				return it->second;
+			}
+		}
+		if(!create){
+			return NO_POINT;
+		}
+		column.sizes.push_back(size);
+		column.values.push_back(0);
+		if(!column.ascending){
+			column.index[size] = n;
+		}
+		return n;
+	}
+
+	PointRef point(SeriesId id, int section, int size){
+		PointRef ref;
+		ref.column = &series[id].columns[section];
+		ref.point = pointIndex(*ref.column, size, true);
+		ref.series = id;
+		ref.section = section;
+		return ref;
+	}
+
+	void writeSample(const PointRef &ref, OPCOUNT_MEASURE value){
+		if(!sampledPoints.empty()){
+			SampleMap::iterator it = sampledPoints.find(std::make_pair(ref.series, ref.column->sizes[ref.point]));
+			if(it != sampledPoints.end()){
+				it->second.values[ref.section].push_back(value);
+			}
+		}
+		for(size_t i=0; i<writers.size(); ++i){
+			writers[i]->sample(ref.series, series[ref.series].name.c_str(), sectionName(ref.section),
+								ref.column->sizes[ref.point], value);
+		}
+	}
+
+	/**
+	* the shards of a chunk start at the first cache line boundary inside it
+	*/
+	static CounterShard *chunkShards(char *chunk){
+		return (CounterShard*)(chunk + (CACHE_LINE_SIZE - (size_t)chunk % CACHE_LINE_SIZE) % CACHE_LINE_SIZE);
+	}
+
+	CounterShard *acquireShard(PointRef target){
+		if(freeShards.empty()){
+			char *chunk = (char*)malloc(SHARDS_PER_CHUNK * sizeof(CounterShard) + CACHE_LINE_SIZE);
+			if(!chunk){
+				throw "out of memory";
+			}
+			shardChunks.push_back(chunk);
+			CounterShard *shards = chunkShards(chunk);
+			for(int i=SHARDS_PER_CHUNK-1; i>=0; --i){
+				new(&shards[i]) CounterShard();
+				shards[i].inUse = false;
+				freeShards.push_back(&shards[i]);
+			}
+		}
+		CounterShard *shard = freeShards.back();
+		freeShards.pop_back();
+		shard->target = target;
+		shard->value.store(0, std::memory_order_relaxed);
+		shard->merged = 0;
+		shard->inUse = true;
+		return shard;
+	}
+
+	void releaseShard(CounterShard *shard){
+		if(shard->target.column){
+			OPCOUNT_MEASURE value = shard->value.load(std::memory_order_relaxed);
+			shard->target.column->values[shard->target.point] += value - shard->merged;
+			writeSample(shard->target, value);
+		}
+		shard->target.column = NULL;
+		shard->inUse = false;
+		freeShards.push_back(shard);
+	}
+
+	/**
+	* adds what the scope of a counter measured to the allocation sections of the point of the counter
+	*/
+	void releaseAllocations(const CounterShard *shard, const AllocationScope &scope){
+		if(!shard->target.column){
+			return;
+		}
+		unsigned long long values[AllocationScope::NR_MEASURES];
+		scope.read(values);
+		int size = shard->target.column->sizes[shard->target.point];
+		for(int i=0; i<AllocationScope::NR_MEASURES; ++i){
+			PointRef ref = point(shard->target.series, ALLOCATIONS + i, size);
+			ref.column->values[ref.point] += values[i];
+			writeSample(ref, values[i]);
+		}
+	}
+
+	/**
+	* returns the child of a node of the call tree with the given name and size, creating it if needed
+	*/
+	size_t scopeNode(size_t parent, const char *name, int size){
+		std::pair<std::string, int> key(name, size);
+		std::map<std::pair<std::string, int>, size_t>::const_iterator it = scopeNodes[parent].children.find(key);
+		if(it != scopeNodes[parent].children.end()){
+			return it->second;
+		}
+		size_t node = scopeNodes.size();
+		scopeNodes.push_back(ScopeNode());
+		scopeNodes.back().name = name;
+		scopeNodes.back().size = size;
+		scopeNodes[parent].children[key] = node;
+		return node;
+	}
+
+	void recordScope(size_t node, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+					 OPCOUNT_MEASURE operations){
+		ScopeNode &scope = scopeNodes[node];
+		OPCOUNT_MEASURE duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		++scope.calls;
+		scope.nanoseconds += duration;
+		scope.operations += operations;
+		if(traceEvents.size() >= maxEvents){
+			++droppedEvents;
+			return;
+		}
+		TraceEvent event;
+		event.node = node;
+		event.start = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count();
+		event.duration = duration;
+		event.operations = operations;
+		event.thread = threadIndex();
+		traceEvents.push_back(event);
+	}
+
+	/**
+	* the threads are numbered in the order in which they record their first scope
+	*/
+	static int threadIndex(){
+		static std::atomic<int> nrThreads(0);
+		static thread_local int index = ++nrThreads;
+		return index;
+	}
+
+	/**
+	* writes the line of every node under the given one, path being the path of the node
+	*/
+	void printFolded(FILE *fout, size_t node, std::string &path, int section){
+		const ScopeNode &scope = scopeNodes[node];
+		OPCOUNT_MEASURE self = section == OPCOUNT ? scope.operations : scope.nanoseconds;
+		size_t length = path.size();
+		std::map<std::pair<std::string, int>, size_t>::const_iterator it;
+		for(it = scope.children.begin(); it != scope.children.end(); ++it){
+			const ScopeNode &child = scopeNodes[it->second];
+			OPCOUNT_MEASURE childValue = section == OPCOUNT ? child.operations : child.nanoseconds;
+			// the children can be given another counter than their parent
+			self = self > childValue ? self - childValue : 0;
+			char frame[MAX_NAME_LEN + 16];
+			snprintf(frame, sizeof(frame), "%s%s(%d)", length == 0 ? "" : ";", child.name.c_str(), child.size);
+			path += frame;
+			printFolded(fout, it->second, path, section);
+			path.resize(length);
+		}
+		if(node != 0 && self > 0){
+			fprintf(fout, "%s %llu\n", path.c_str(), self);
+		}
+	}
+
+	void describeRun(ReportWriter *writer){
+		std::map<std::string, std::string>::const_iterator it;
+		for(it = environment.begin(); it != environment.end(); ++it){
+			writer->environment(it->first.c_str(), it->second.c_str());
+		}
+	}
+
+	static FILE *openFile(const char *fileName){
+		FILE *fout = NULL;
+#ifdef _MSC_VER
+		fopen_s(&fout, fileName, "w");
+#else
+		fout = fopen(fileName, "w");
+#endif
+		if(!fout){
+			throw "could not open the report file";
+		}
+		return fout;
+	}
+
+	static void printJsonString(FILE *fout, const char *str){
+		for(int i=0; str[i] != 0; ++i){
+			if(str[i] == '"' || str[i] == '\\'){
+				fprintf(fout, "\\%c", str[i]);
+			}else if((unsigned char)str[i] < 0x20){
+				fprintf(fout, "\\u%04x", str[i]);
+			}else{
+				fputc(str[i], fout);
+			}
+		}
+	}
+
+	/**
+	* adds the accesses and the misses simulated for a counter to the simulated cache sections of its point
+	*/
+	void releaseCache(const CounterShard *shard, const CacheSimulator &cache){
+		if(!shard->target.column){
+			return;
+		}
+		unsigned long long values[CacheSimulator::NR_MEASURES];
+		cache.read(values);
+		int size = shard->target.column->sizes[shard->target.point];
+		for(int i=0; i<CacheSimulator::NR_MEASURES; ++i){
+			if(i > cache.levelCount()){
+				break;
+			}
+			PointRef ref = point(shard->target.series, SIMULATED_CACHE + i, size);
+			ref.column->values[ref.point] += values[i];
+			writeSample(ref, values[i]);
+		}
+	}
+
+	/**
+	* the part of the value of a shard not yet added to its series. the shards are only read here,
+	* the thread of a counter can keep counting while its value is merged
+	*/
+	static OPCOUNT_MEASURE unmerged(const CounterShard &shard){
+		return shard.value.load(std::memory_order_relaxed) - shard.merged;
+	}
+
+	/**
+	* adds the values of the shards in use to their series
+	*/
+	void mergeShards(){
+		for(size_t i=0; i<shardChunks.size(); ++i){
+			CounterShard *shards = chunkShards(shardChunks[i]);
+			for(int j=0; j<SHARDS_PER_CHUNK; ++j){
+				if(shards[j].inUse && shards[j].target.column){
+					OPCOUNT_MEASURE value = unmerged(shards[j]);
+					shards[j].target.column->values[shards[j].target.point] += value;
+					shards[j].merged += value;
+				}
+			}
+		}
+	}
+
+	void detachShards(){
+		for(size_t i=0; i<shardChunks.size(); ++i){
+			CounterShard *shards = chunkShards(shardChunks[i]);
+			for(int j=0; j<SHARDS_PER_CHUNK; ++j){
+				shards[j].target.column = NULL;
+				shards[j].merged = shards[j].value.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	* the value of the point the shard counts for, without modifying the shards of the other threads
+	*/
+	OPCOUNT_MEASURE pointValue(const CounterShard *shard){
+		if(!shard->target.column){
+			return unmerged(*shard);
+		}
+		OPCOUNT_MEASURE value = shard->target.column->values[shard->target.point];
+		for(size_t i=0; i<shardChunks.size(); ++i){
+			CounterShard *shards = chunkShards(shardChunks[i]);
+			for(int j=0; j<SHARDS_PER_CHUNK; ++j){
+				if(shards[j].inUse && shards[j].target.column == shard->target.column &&
+					shards[j].target.point == shard->target.point){
+					value += unmerged(shards[j]);
+				}
+			}
+		}
+		return value;
+	}
+
+	/**
+	* writes one section of the report (a series name -> [[size, value], ...] object), with the points sorted by size
+	*/
+	void printSection(FILE *fout, int section){
+		bool hasSequences = false;
+		std::vector<size_t> order;
+		fprintf(fout, "\t\"%s\": {\n", sectionName(section));
+		for(size_t i=0; i<series.size(); ++i){
+			const Column &column = series[i].columns[section];
+			if(column.sizes.empty()){
+				continue;
+			}
+			fprintf(fout, hasSequences ? ",\n\t\t\"" : "\t\t\"");
+			hasSequences = true;
+			print_modified(fout, series[i].name.c_str());
+			fprintf(fout, "\": [");
+			sortedPoints(column, order);
+			for(size_t j=0; j<order.size(); ++j){
+				fprintf(fout, "%s[%d, %llu]", j == 0 ? "" : ", ", column.sizes[order[j]], column.values[order[j]]);
+			}
+			fprintf(fout, "]");
+		}
+		fprintf(fout, hasSequences ? "\n\t},\n" : "\t},\n");
+	}
+
+	static void computeStatistics(const std::vector<OPCOUNT_MEASURE> &samples, Statistics &stats){
+		size_t n = samples.size();
+		stats.samples = samples;
+		std::vector<OPCOUNT_MEASURE> sorted(samples);
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0, squares = 0;
+		for(size_t i=0; i<n; ++i){
+			sum += (double)sorted[i];
+		}
+		stats.mean = sum / n;
+		for(size_t i=0; i<n; ++i){
+			squares += ((double)sorted[i] - stats.mean) * ((double)sorted[i] - stats.mean);
+		}
+		stats.stddev = n > 1 ? sqrt(squares / (n - 1)) : 0;
+		stats.median = n % 2 ? (double)sorted[n / 2] : ((double)sorted[n / 2 - 1] + (double)sorted[n / 2]) / 2;
+		// nearest rank percentiles
+		stats.p95 = (double)sorted[(size_t)ceil(0.95 * n) - 1];
+		stats.p99 = (double)sorted[(size_t)ceil(0.99 * n) - 1];
+	}
+
+	static void sortedPoints(const Column &column, std::vector<size_t> &order){
+		order.resize(column.sizes.size());
+		for(size_t i=0; i<order.size(); ++i){
+			order[i] = i;
+		}
+		if(!column.ascending){
+			std::sort(order.begin(), order.end(), [&column](size_t a, size_t b) { return column.sizes[a] < column.sizes[b]; });
+		}
+	}
+
+	void print_modified(FILE *f, const char *str){
+		int i = 0;
+		while(str[i] != 0){
+			if(isalnum(str[i]) || str[i] == '_'){
+				fprintf(f, "%c", str[i]);
+			}else{
+				fprintf(f, "_");
+			}
+			++i;
+		}
+	}
+};
+
+typedef Profiler::OperationCounter Operation;
+typedef Profiler::ScopedTimer Timer;
+typedef Profiler::ProfileScope Scope;
+
+/**
+* counting policy that counts nothing. an algorithm templated on the counting policy and
+* instantiated with NullOperation has no instrumentation left in it after inlining
+*/
+class NullOperation{
+public:
+	template <typename Name>
+	NullOperation(Profiler &, Name, int) {}
+	void count(int = 1) {}
+	Profiler::OPCOUNT_MEASURE counted() const { return 0; }
+	Profiler::OPCOUNT_MEASURE get() const { return 0; }
+};
+
+/**
+* the counting policy of the algorithms that are not given one explicitly.
+* define PROFILER_NO_OPCOUNT to build them without operation counting
+*/
+#ifdef PROFILER_NO_OPCOUNT
+typedef NullOperation DefaultOperation;
+#else
+typedef Operation DefaultOperation;
+#endif
+
+/**
+* the counters of the element accesses made through CountedArray and CountedCompare, in the series name_reads,
+* name_writes, name_swaps and name_comparisons at the given size. with NullOperation nothing is counted
+*/
+template <typename Counter = DefaultOperation>
+class CountedOperations{
+public:
+	CountedOperations(Profiler &profiler, const char *name, int size)
+		: reads(profiler.createCounter<Counter>((std::string(name) + "_reads").c_str(), size)),
+		  writes(profiler.createCounter<Counter>((std::string(name) + "_writes").c_str(), size)),
+		  swaps(profiler.createCounter<Counter>((std::string(name) + "_swaps").c_str(), size)),
+		  comparisons(profiler.createCounter<Counter>((std::string(name) + "_comparisons").c_str(), size)) {}
+
+	/**
+	* the names of the series of name: name_reads, name_writes, name_swaps and name_comparisons
+	*/
+	static std::vector<std::string> seriesNames(const char *name){
+		static const char *suffixes[] = {"_reads", "_writes", "_swaps", "_comparisons"};
+		std::vector<std::string> names;
+		for(int i=0; i<4; ++i){
+			names.push_back(std::string(name) + suffixes[i]);
+		}
+		return names;
+	}
+
+	Counter reads, writes, swaps, comparisons;
+};
+
+/**
+* an array that counts the accesses to its elements: reading an element counts a read, assigning it counts a write
+* and comparing it to another element or to a value counts a comparison (besides the reads).
+* it is used like a pointer where the algorithm takes an int *: &array[i] is the array positioned at i, and the
+* swap(&array[i], &array[j]) of the assignments counts a single swap. with NullOperation it is a plain pointer
+*/
+template <typename T, typename Counter = DefaultOperation>
+class CountedArray{
+public:
+	class Reference{
+	public:
+		Reference(const Reference &other) = default;
+
+		operator T() const{
+			operations->reads.count();
+			return *element;
+		}
+
+		Reference &operator=(const T &value){
+			operations->writes.count();
+			*element = value;
+			return *this;
+		}
+
+		Reference &operator=(const Reference &other){
+			return *this = (T)other;
+		}
+
+		CountedArray operator&() const{
+			return CountedArray(element, *operations);
+		}
+
+		// the comparisons between two elements, and between an element and a value
+#define COUNTED_COMPARISON(op) \
+		friend bool operator op(const Reference &a, const Reference &b){ a.operations->comparisons.count(); return (T)a op (T)b; } \
+		friend bool operator op(const Reference &a, const T &b){ a.operations->comparisons.count(); return (T)a op b; } \
+		friend bool operator op(const T &a, const Reference &b){ b.operations->comparisons.count(); return a op (T)b; }
+		COUNTED_COMPARISON(<)
+		COUNTED_COMPARISON(>)
+		COUNTED_COMPARISON(<=)
+		COUNTED_COMPARISON(>=)
+		COUNTED_COMPARISON(==)
+		COUNTED_COMPARISON(!=)
+#undef COUNTED_COMPARISON
+
+	private:
+		friend class CountedArray;
+		Reference(T *givenElement, CountedOperations<Counter> *givenOperations)
+			: element(givenElement), operations(givenOperations) {}
+
+		T *element;
+		CountedOperations<Counter> *operations;
+	};
+
+	CountedArray(T *givenData, CountedOperations<Counter> &givenOperations) : data(givenData), ops(&givenOperations) {}
+
+	Reference operator[](long long index) const{
+		return Reference(data + index, ops);
+	}
+
+	Reference operator*() const{
+		return Reference(data, ops);
+	}
+
+	CountedArray operator+(long long offset) const{
+		return CountedArray(data + offset, *ops);
+	}
+
+	T *get() const{
+		return data;
+	}
+
+	CountedOperations<Counter> &operations() const{
+		return *ops;
+	}
+
+private:
+	T *data;
+	CountedOperations<Counter> *ops;
+};
+
+/**
+* swaps two elements of counted arrays, counted as one swap
+*/
+template <typename T, typename Counter>
+void swap(CountedArray<T, Counter> x, CountedArray<T, Counter> y){
+	x.operations().swaps.count();
+	T temp = *x.get();
+	*x.get() = *y.get();
+	*y.get() = temp;
+}
+
+/**
+* a comparator that counts its calls, for the algorithms that take one (std::sort, std::priority_queue, ...)
+*/
+template <typename T, typename Counter = DefaultOperation, typename Compare = std::less<T> >
+class CountedCompare{
+public:
+	CountedCompare(CountedOperations<Counter> &givenOperations, Compare givenCompare = Compare())
+		: operations(&givenOperations), compare(givenCompare) {}
+
+	bool operator()(const T &a, const T &b) const{
+		operations->comparisons.count();
+		return compare(a, b);
+	}
+
+private:
+	CountedOperations<Counter> *operations;
+	Compare compare;
+};
+
+/**
+* isolates the samples of a BenchmarkRunner from the rest of the machine: pins the thread to a core, runs untimed
+* warmup iterations and puts the caches in a known state before every sample. the caches are either cold (flushed
+* by walking a buffer larger than the last level) or warm (flushed, then holding only the regions given with
+* warmRegion; with no region, the caches stay as prepare() left them, which is warm for inputs that fit).
+* the inputs can be allocated on huge pages, so that their TLB misses do not depend on where the allocator placed them
+*/
+class BenchmarkIsolation{
+public:
+	enum CacheState { AS_PREPARED = 0, COLD, WARM, NR_CACHE_STATES };
+
+	static const size_t HUGE_PAGE_SIZE = 2 << 20;
+	static const size_t DEFAULT_FLUSH_BYTES = 64 << 20;
+
+	BenchmarkIsolation() : core(-1), warmups(0), caches(AS_PREPARED), flushBytes(DEFAULT_FLUSH_BYTES) {}
+
+	/**
+	* the core the runner is pinned to, -1 to let the scheduler move it
+	*/
+	void setCore(int givenCore){
+		core = givenCore;
+	}
+
+	void setWarmups(int givenWarmups){
+		warmups = givenWarmups < 0 ? 0 : givenWarmups;
+	}
+
+	/**
+	* flushBytes must be larger than the last level cache
+	*/
+	void setCacheState(CacheState state, size_t givenFlushBytes = DEFAULT_FLUSH_BYTES){
+		caches = state;
+		flushBytes = givenFlushBytes;
+	}
+
+	/**
+	* adds a region that is brought into the caches before every sample when they are warm
+	*/
+	void warmRegion(const void *data, size_t bytes){
+		regions.push_back(std::make_pair((const char*)data, bytes));
+	}
+
+	void clearRegions(){
+		regions.clear();
+	}
+
+	int warmupCount() const{
+		return warmups;
+	}
+
+	CacheState cacheState() const{
+		return caches;
+	}
+
+	/**
+	* pins the calling thread and records the isolation and the state of the core in the environment of the report
+	*/
+	void apply(Profiler &profiler){
+		char value[32];
+		int described = core >= 0 ? core : 0;
+
+		if(core >= 0){
+			pinToCore(core);
+		}
+		snprintf(value, sizeof(value), core >= 0 ? "%d" : "any", core);
+		profiler.describeEnvironment("cpu core", value);
+		profiler.describeEnvironment("cpu governor", cpuGovernor(described).c_str());
+		profiler.describeEnvironment("cpu frequency", cpuFrequency(described).c_str());
+		snprintf(value, sizeof(value), "%d", warmups);
+		profiler.describeEnvironment("warmup iterations", value);
+		profiler.describeEnvironment("caches between samples", cacheStateName(caches));
+	}
+
+	/**
+	* puts the caches in the requested state, called between prepare() and the timed measure()
+	*/
+	void prepareCaches(){
+		if(caches == COLD || (caches == WARM && !regions.empty())){
+			flushCaches();
+		}
+		if(caches == WARM){
+			for(size_t i=0; i<regions.size(); ++i){
+				touch(regions[i].first, regions[i].second);
+			}
+		}
+	}
+
+	/**
+	* evicts everything else from the caches, writing the buffer so that the dirty lines are written back as well
+	*/
+	void flushCaches(){
+		if(evictionBuffer.size() != flushBytes){
+			evictionBuffer.assign(flushBytes, 0);
+		}
+		for(size_t i=0; i<evictionBuffer.size(); i+=CACHE_LINE){
+			++evictionBuffer[i];
+		}
+		touch(&evictionBuffer[0], evictionBuffer.size());
+	}
+
+	static const char *cacheStateName(int state){
+		static const char *names[NR_CACHE_STATES] = {"as prepared", "cold", "warm"};
+		return names[state];
+	}
+
+	/**
+	* returns the cache state with the given name, or throws
+	*/
+	static CacheState findCacheState(const char *name){
+		for(int i=0; i<NR_CACHE_STATES; ++i){
+			if(strcmp(cacheStateName(i), name) == 0){
+				return (CacheState)i;
+			}
+		}
+		throw "unknown cache state";
+	}
+
+	/**
+	* pins the calling thread to a core, or throws
+	*/
+	static void pinToCore(int core){
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		if(core >= CPU_SETSIZE || sched_setaffinity(0, sizeof(set), &set) != 0){
+			throw "could not pin the thread to the core";
+		}
+#elif defined(_MSC_VER)
+		if(core >= 64 || SetThreadAffinityMask(GetCurrentThread(), 1ULL << core) == 0){
+			throw "could not pin the thread to the core";
+		}
+#else
+		(void)core;
+		throw "pinning a thread to a core is not supported on this system";
+#endif
+	}
+
+	/**
+	* the frequency governor of a core (performance, powersave, ...), "unknown" where it cannot be read
+	*/
+	static std::string cpuGovernor(int core){
+		char buffer[64];
+		return readCpuFile(core, "scaling_governor", buffer, sizeof(buffer)) ? buffer : "unknown";
+	}
+
+	/**
+	* the current frequency of a core and the range the governor keeps it in, "unknown" where it cannot be read
+	*/
+	static std::string cpuFrequency(int core){
+		char current[32], minimum[32], maximum[32], result[128];
+		if(!readCpuFile(core, "scaling_cur_freq", current, sizeof(current))){
+			return "unknown";
+		}
+		if(!readCpuFile(core, "scaling_min_freq", minimum, sizeof(minimum)) ||
+		   !readCpuFile(core, "scaling_max_freq", maximum, sizeof(maximum))){
+			snprintf(result, sizeof(result), "%lld MHz", atoll(current) / 1000);
+		}else{
+			snprintf(result, sizeof(result), "%lld MHz (%lld - %lld MHz)", atoll(current) / 1000,
+					 atoll(minimum) / 1000, atoll(maximum) / 1000);
+		}
+		return result;
+	}
+
+	/**
+	* allocates bytes aligned to a huge page and asks the kernel to back them with huge pages.
+	* the memory is released with freeHugePages
+	*/
+	static void *allocateHugePages(size_t bytes){
+		size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		void *data = NULL;
+#ifdef _MSC_VER
+		data = _aligned_malloc(rounded, HUGE_PAGE_SIZE);
+#else
+		if(posix_memalign(&data, HUGE_PAGE_SIZE, rounded) != 0){
+			data = NULL;
+		}
+#endif
+		if(!data){
+			throw "out of memory";
+		}
+#ifdef __linux__
+		// only a hint: without transparent huge pages the memory stays on small pages
+		madvise(data, rounded, MADV_HUGEPAGE);
+#endif
+		return data;
+	}
+
+	static void freeHugePages(void *data){
+#ifdef _MSC_VER
+		_aligned_free(data);
+#else
+		free(data);
+#endif
+	}
+
+private:
+	static const size_t CACHE_LINE = 64;
+
+	int core, warmups;
+	CacheState caches;
+	size_t flushBytes;
+	std::vector<std::pair<const char*, size_t> > regions;
+	std::vector<char> evictionBuffer;
+
+	/**
+	* reads one line of every cache line of the region
+	*/
+	static void touch(const char *data, size_t bytes){
+		volatile char sink = 0;
+		char sum = 0;
+		for(size_t i=0; i<bytes; i+=CACHE_LINE){
+			sum += data[i];
+		}
+		sink = sum;
+		(void)sink;
+	}
+
+	/**
+	* reads the first line of a file of /sys/devices/system/cpu/cpuN/cpufreq, without its newline
+	*/
+	static bool readCpuFile(int core, const char *name, char *buffer, int size){
+#ifdef __linux__
+		char path[128];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/%s", core, name);
+		FILE *fin = fopen(path, "r");
+		if(!fin){
+			return false;
+		}
+		bool read = fgets(buffer, size, fin) != NULL;
+		fclose(fin);
+		if(read){
+			buffer[strcspn(buffer, "\n")] = 0;
+		}
+		return read;
+#else
+		(void)core; (void)name; (void)buffer; (void)size;
+		return false;
+#endif
+	}
+};
+
+/**
+* repeats every point of a benchmark until the mean of its samples is known with the requested confidence:
+* until the confidence interval of the mean is narrower than relativeError * mean in every measured section,
+* but at least minSamples and at most maxSamples times. the point keeps the mean and gets the median, p95, p99
+* and standard deviation series next to it (see Profiler::summarizeSamples). the raw samples can be streamed
+* with Profiler::streamReport
+*/
+class BenchmarkRunner{
+public:
+	BenchmarkRunner(Profiler &givenProfiler, double givenConfidence = 0.95, double givenRelativeError = 0.02,
+					int givenMinSamples = 5, int givenMaxSamples = 100)
+		: profiler(givenProfiler), confidence(givenConfidence), relativeError(givenRelativeError),
+		  minSamples(givenMinSamples < 2 ? 2 : givenMinSamples), maxSamples(givenMaxSamples), isolation(NULL) {}
+
+	/**
+	* isolates the samples taken from now on, see BenchmarkIsolation. the isolation must outlive the runner
+	*/
+	void isolate(BenchmarkIsolation &givenIsolation){
+		isolation = &givenIsolation;
+		isolation->apply(profiler);
+	}
+
+	/**
+	* measures the point (name, size) by calling prepare() and then measure() until it converges, and returns
+	* the number of samples taken. only measure() is timed, under name. the operation counters created during
+	* measure() for name, or for one of the series in alsoSampled, are sampled as well, one sample per counter
+	*/
+	template <typename Prepare, typename Measure>
+	int run(const char *name, int size, Prepare prepare, Measure measure,
+			const std::vector<const char*> &alsoSampled = std::vector<const char*>()){
+		return runChecked(name, size, prepare, measure, [](){}, alsoSampled);
+	}
+
+	/**
+	* same as run, with check() called after every measure(), outside the timed region: it checks the result
+	* of the measured algorithm (that a sort left its output sorted, for instance) and throws when it is wrong
+	*/
+	template <typename Prepare, typename Measure, typename Check>
+	int runChecked(const char *name, int size, Prepare prepare, Measure measure, Check check,
+				   const std::vector<const char*> &alsoSampled = std::vector<const char*>()){
+		std::vector<Profiler::SeriesId> ids(1, profiler.seriesId(name));
+		for(size_t i=0; i<alsoSampled.size(); ++i){
+			ids.push_back(profiler.seriesId(alsoSampled[i]));
+		}
+		// the warmup iterations come before the samples are kept, the mean of the samples then replaces what they counted
+		for(int i=0; isolation && i<isolation->warmupCount(); ++i){
+			prepare();
+			measure();
+			check();
+		}
+		for(size_t i=0; i<ids.size(); ++i){
+			profiler.keepSamples(ids[i], size);
+		}
+
+		int samples = 0;
+		do{
+			prepare();
+			if(isolation){
+				isolation->prepareCaches();
+			}
+			Timer timer = profiler.createTimer(ids[0], size);
+			measure();
+			timer.stop();
+			check();
+			++samples;
+		}while(samples < maxSamples && (samples < minSamples || !converged(ids, size)));
+
+		for(size_t i=0; i<ids.size(); ++i){
+			profiler.summarizeSamples(ids[i], size);
+		}
+		return samples;
+	}
+
+	/**
+	* same as above, for measurements that need no preparation
+	*/
+	template <typename Measure>
+	int run(const char *name, int size, Measure measure){
+		return run(name, size, [](){}, measure);
+	}
+
+	/**
+	* same as run, for the algorithms measured with CountedArray and CountedCompare: measure(operations) is given the
+	* CountedOperations of name to count through, and their four series are sampled alongside name
+	*/
+	template <typename Prepare, typename Measure>
+	int runCounted(const char *name, int size, Prepare prepare, Measure measure){
+		return runCounted(name, size, prepare, measure, [](){});
+	}
+
+	/**
+	* same as above, with check() called after every measure() as in runChecked
+	*/
+	template <typename Prepare, typename Measure, typename Check>
+	int runCounted(const char *name, int size, Prepare prepare, Measure measure, Check check){
+		std::vector<std::string> series = CountedOperations<>::seriesNames(name);
+		std::vector<const char*> alsoSampled;
+		for(size_t i=0; i<series.size(); ++i){
+			alsoSampled.push_back(series[i].c_str());
+		}
+		return runChecked(name, size, prepare, [&](){
+			CountedOperations<> operations(profiler, name, size);
+			measure(operations);
+		}, check, alsoSampled);
+	}
+
+private:
+	Profiler &profiler;
+	double confidence, relativeError;
+	int minSamples, maxSamples;
+	BenchmarkIsolation *isolation;
+
+	bool converged(const std::vector<Profiler::SeriesId> &ids, int size){
+		Profiler::Statistics stats;
+		for(size_t i=0; i<ids.size(); ++i){
+			for(int section=0; section<Profiler::NR_SECTIONS; ++section){
+				// a few calls to the allocator are too short to time precisely, the point does not wait for them
+				if(section == Profiler::ALLOCATIONS + AllocationScope::NANOSECONDS ||
+				   !profiler.sampleStatistics(ids[i], size, section, stats)){
+					continue;
+				}
+				double n = (double)stats.samples.size();
+				if(studentQuantile(n - 1) * stats.stddev / sqrt(n) > relativeError * stats.mean){
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	* the two sided quantile of the Student t distribution with the given degrees of freedom: the normal
+	* quantile (Abramowitz and Stegun 26.2.23) corrected with the Cornish-Fisher expansion
+	*/
+	double studentQuantile(double df) const{
+		double p = (1 - confidence) / 2;
+		double t = sqrt(-2 * log(p));
+		double z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t) / (1 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+		double z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z, z9 = z7 * z * z;
+		return z + (z3 + z) / (4 * df)
+				 + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df)
+				 + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * df * df * df)
+				 + (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / (92160 * df * df * df * df);
+	}
+};
+
+/**
+* fits growth models value = constant * f(size) to the series of a profiler, to check the complexity claimed
+* for an algorithm and to compare a run against a baseline saved by an earlier run.
+* the models with a parameter take the size as the varying quantity and the parameter as the fixed one:
+* N_LOG_K is parameter * log k for a series over k (n fixed), E_PLUS_V is E + parameter for a series over E (V fixed)
+*/
+class ComplexityAnalysis{
+public:
+	enum Model { LINEAR = 0, N_LOG_N, QUADRATIC, N_LOG_K, E_PLUS_V, NR_MODELS };
+
+	struct Fit{
+		Model model = LINEAR;
+		double constant = 0;
+		// the root mean square of the relative residuals
+		double error = 0;
+	};
+
+	ComplexityAnalysis(Profiler &givenProfiler) : profiler(givenProfiler) {}
+
+	static const char *modelName(int model){
+		static const char *names[NR_MODELS] = {"n", "n log n", "n^2", "n log k", "E + V"};
+		return names[model];
+	}
+
+	/**
+	* sets the fixed parameter (n or V) of a series, which enables the N_LOG_K and E_PLUS_V models for it
+	*/
+	void setParameter(const char *name, double parameter){
+		parameters[name] = parameter;
+	}
+
+	/**
+	* fits one model to a series. returns false if the series has less than 3 points in the section
+	*/
+	bool fit(const char *name, int section, Model model, Fit &result){
+		std::vector<int> sizes;
+		std::vector<Profiler::OPCOUNT_MEASURE> values;
+		if(!profiler.seriesPoints(name, section, sizes, values) || sizes.size() < 3){
+			return false;
+		}
+		double parameter = parameters.count(name) ? parameters[name] : 0;
+		// least squares on the relative residuals, so that the large sizes do not hide the small ones
+		double num = 0, den = 0, sum = 0;
+		for(size_t i=0; i<sizes.size(); ++i){
+			double f = modelValue(model, sizes[i], parameter), y = (double)values[i];
+			if(y > 0){
+				num += f / y;
+				den += f * f / (y * y);
+			}
+		}
+		result.model = model;
+		result.constant = den > 0 ? num / den : 0;
+		for(size_t i=0; i<sizes.size(); ++i){
+			double y = (double)values[i] > 0 ? (double)values[i] : 1;
+			double residual = (y - result.constant * modelValue(model, sizes[i], parameter)) / y;
+			sum += residual * residual;
+		}
+		result.error = sqrt(sum / sizes.size());
+		return true;
+	}
+
+	/**
+	* the model that fits the series best. the models with a parameter are only tried if it was set
+	*/
+	bool bestFit(const char *name, int section, Fit &best){
+		Fit current;
+		bool found = false;
+		int nrModels = parameters.count(name) ? NR_MODELS : N_LOG_K;
+		for(int model=0; model<nrModels; ++model){
+			if(fit(name, section, (Model)model, current) && (!found || current.error < best.error)){
+				best = current;
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	/**
+	* checks that a series does not grow faster than claimed, and prints the best fit
+	*/
+	bool verify(const char *name, int section, Model claimed){
+		Fit best;
+		if(!bestFit(name, section, best)){
+			return false;
+		}
+		bool ok = growth(best.model) <= growth(claimed);
+		printf("%s (%s): best fit %.4g * %s (error %.3f), claimed %s: %s\n", name, Profiler::sectionName(section),
+			   best.constant, modelName(best.model), best.error, modelName(claimed), ok ? "ok" : "FAILED");
+		return ok;
+	}
+
+	/**
+	* saves the best fit of every series of the section, one per line: series, section, model, parameter, constant
+	*/
+	void saveBaseline(const char *fileName, int section = Profiler::OPCOUNT){
+		FILE *fout = NULL;
+#ifdef _MSC_VER
+		fopen_s(&fout, fileName, "w");
+#else
+		fout = fopen(fileName, "w");
+#endif
+		if(!fout){
+			throw "could not open the baseline file";
+		}
+		std::vector<std::string> names = profiler.seriesNames();
+		Fit best;
+		for(size_t i=0; i<names.size(); ++i){
+			if(bestFit(names[i].c_str(), section, best)){
+				fprintf(fout, "%s\t%s\t%d\t%.17g\t%.17g\n", names[i].c_str(), Profiler::sectionName(section), (int)best.model,
+						parameters.count(names[i]) ? parameters[names[i]] : 0.0, best.constant);
+			}
+		}
+		fclose(fout);
+	}
+
+	/**
+	* compares the current run against a baseline and prints every regression: a series that now grows faster,
+	* or whose constant for the baseline model grew by more than the tolerance. returns the number of regressions
+	*/
+	int compareBaseline(const char *fileName, double tolerance = 0.1){
+		FILE *fin = NULL;
+#ifdef _MSC_VER
+		fopen_s(&fin, fileName, "r");
+#else
+		fin = fopen(fileName, "r");
+#endif
+		if(!fin){
+			throw "could not open the baseline file";
+		}
+		char line[4 * Profiler::MAX_NAME_LEN];
+		int regressions = 0;
+		while(fgets(line, sizeof(line), fin)){
+			char *name = strtok(line, "\t"), *sectionName = strtok(NULL, "\t"), *model = strtok(NULL, "\t");
+			char *parameter = strtok(NULL, "\t"), *constant = strtok(NULL, "\t\r\n");
+			int section = findSection(sectionName);
+			if(!constant || section < 0){
+				continue;
+			}
+			Fit baseline, current, best;
+			baseline.model = (Model)atoi(model);
+			baseline.constant = atof(constant);
+			if(atof(parameter) > 0){
+				setParameter(name, atof(parameter));
+			}
+			if(!fit(name, section, baseline.model, current) || !bestFit(name, section, best)){
+				printf("%s (%s): missing from this run\n", name, sectionName);
+				++regressions;
+			}else if(growth(best.model) > growth(baseline.model) && current.error > 2 * best.error){
+				printf("%s (%s): grows as %s, the baseline grew as %s\n", name, sectionName,
+					   modelName(best.model), modelName(baseline.model));
+				++regressions;
+			}else if(current.constant > baseline.constant * (1 + tolerance)){
+				printf("%s (%s): %.4g * %s, the baseline was %.4g * %s\n", name, sectionName,
+					   current.constant, modelName(current.model), baseline.constant, modelName(baseline.model));
+				++regressions;
+			}
+		}
+		fclose(fin);
+		return regressions;
+	}
+
+private:
+	Profiler &profiler;
+	std::map<std::string, double> parameters;
+
+	static double modelValue(Model model, int size, double parameter){
+		double n = size > 1 ? size : 1;
+		switch(model){
+		case LINEAR: return n;
+		case N_LOG_N: return n * log2(n);
+		case QUADRATIC: return n * n;
+		case N_LOG_K: return parameter * log2(n);
+		default: return n + parameter;
+		}
+	}
+
+	/**
+	* the models in the order of their growth in the size
+	*/
+	static int growth(Model model){
+		static const int ranks[NR_MODELS] = {1, 2, 3, 0, 1};
+		return ranks[model];
+	}
+
+	static int findSection(const char *name){
+		for(int section=0; name && section<Profiler::NR_SECTIONS; ++section){
+			if(strcmp(name, Profiler::sectionName(section)) == 0){
+				return section;
+			}
+		}
+		return -1;
+	}
+};
+
+/**
+* xoshiro256** pseudo random generator: fast, with a period of 2^256 - 1 and fully determined by its seed.
+* different streams of the same seed are independent for all practical purposes, which is what the
+* parallel generators below rely on
+*/
+class RandomGenerator{
+public:
+	RandomGenerator(unsigned long long seed = 0x853c49e6748fea9bULL, unsigned long long stream = 0){
+		// the state is expanded from the seed with splitmix64, as recommended by the authors
+		unsigned long long x = seed ^ (stream * 0xd1342543de82ef95ULL);
+		for(int i=0; i<4; ++i){
+			x += 0x9e3779b97f4a7c15ULL;
+			unsigned long long z = x;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			state[i] = z ^ (z >> 31);
+		}
+	}
+
+	unsigned long long next(){
+		unsigned long long result = rotl(state[1] * 5, 7) * 9, t = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+		return result;
+	}
+
+	/**
+	* an unbiased draw from [0, range), range 0 meaning the whole 64 bit range (Lemire's multiply and reject)
+	*/
+	unsigned long long bounded(unsigned long long range){
+		if(range == 0){
+			return next();
+		}
+#ifdef __SIZEOF_INT128__
+		unsigned __int128 m = (unsigned __int128)next() * range;
+		if((unsigned long long)m < range){
+			unsigned long long threshold = (0 - range) % range;
+			while((unsigned long long)m < threshold){
+				m = (unsigned __int128)next() * range;
+			}
+		}
+		return (unsigned long long)(m >> 64);
+#else
+		unsigned long long threshold = (0 - range) % range, r;
+		do{
+			r = next();
+		}while(r < threshold);
+		return r % range;
+#endif
+	}
+
+	/**
+	* a draw from [0, 1) with 53 random bits
+	*/
+	double uniform(){
+		return (next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	/**
+	* advances the generator by 2^128 draws, giving a non overlapping sequence
+	*/
+	void jump(){
+		static const unsigned long long polynomial[] = {
+			0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+		};
+		unsigned long long jumped[4] = {0, 0, 0, 0};
+		for(int i=0; i<4; ++i){
+			for(int b=0; b<64; ++b){
+				if(polynomial[i] & (1ULL << b)){
+					for(int j=0; j<4; ++j){
+						jumped[j] ^= state[j];
+					}
+				}
+				next();
+			}
+		}
+		for(int j=0; j<4; ++j){
+			state[j] = jumped[j];
+		}
+	}
+
+private:
+	unsigned long long state[4];
+
+	static unsigned long long rotl(unsigned long long x, int k){
+		return (x << k) | (x >> (64 - k));
+	}
+};
+
+/**
+* the generator used by FillRandomArray when it is not given one. it starts from a fixed seed,
+* so the same program generates the same arrays on every run
+*/
+inline RandomGenerator &DefaultRandomGenerator(){
+	static RandomGenerator generator;
+	return generator;
+}
+
+inline void SetRandomSeed(unsigned long long seed){
+	DefaultRandomGenerator() = RandomGenerator(seed);
+}
+
+/**
+* a uniform value in [range_min, range_max]
+*/
+template <typename T>
+	T RandomValue(RandomGenerator &generator, T range_min, T range_max){
+		if(std::is_floating_point<T>::value){
+			return range_min + (T)(generator.uniform() * (range_max - range_min));
+		}
+		unsigned long long interval_len = (unsigned long long)((long long)range_max - (long long)range_min) + 1;
+		return (T)((long long)range_min + (long long)generator.bounded(interval_len));
+	}
+
+/**
+* Fisher-Yates shuffle
+*/
+template <typename T>
+	void ShuffleArray(T *arr, long long size, RandomGenerator &generator){
+		for(long long i=size-1; i>0; --i){
+			std::swap(arr[i], arr[generator.bounded(i + 1)]);
+		}
+	}
+
+enum SortMethod { UNSORTED=0, ASCENDING=1, DESCENDING=2 };
+/**
+* fills the given array with random elements in the given range, drawn from the given generator.
+* optionally, the array can be unique or sorted in ascending (1) or descending (2) order
+*/
+template <typename T>
+	void FillRandomArray(T *arr, int size, T range_min, T range_max, bool unique, int sorted, RandomGenerator &generator){
+		int i, pos;
+		unsigned long long j, interval_len, extendedSize;
+
+		if(range_min >= range_max){
+			throw "empty range";
+		}
+		
+		if(!unique){
+			//no worries
+			for(i=0; i<size; ++i){
+				arr[i] = RandomValue(generator, range_min, range_max);
+			}
+			if(sorted == ASCENDING){
+				std::sort(arr, arr + size);
+			}else if(sorted == DESCENDING){
+				std::sort(arr, arr + size, std::greater<T>());
+			}
+			return;
+		}
+		if(!std::is_floating_point<T>::value){
+			interval_len = (unsigned long long)((long long)range_max - (long long)range_min) + 1;
+			if(interval_len < (unsigned long long)size){
+				throw "range too small";
+			}
+			if(interval_len <= 4 * (unsigned long long)size){
+				//use Knuth approach, which is linear in the range, but the range is small here
+				pos = 0;
+				for(j=0; pos<size; ++j){
+					if(generator.bounded(interval_len - j) < (unsigned long long)(size - pos)){
+						arr[pos++] = (T)((long long)range_min + (long long)j);
+					}
+				}
+			}else{
+				//use Floyd's approach, which picks each of the size values with one draw
+				std::unordered_set<unsigned long long> chosen;
+				chosen.reserve(2 * size);
+				pos = 0;
+				for(j=interval_len-size; j<interval_len; ++j){
+					unsigned long long value = generator.bounded(j + 1);
+					if(!chosen.insert(value).second){
+						value = j;
+						chosen.insert(value);
+					}
+					arr[pos++] = (T)((long long)range_min + (long long)value);
+				}
+				std::sort(arr, arr + size);
+			}
+		}else{
+			//use the same approach as above, pick integers from 0 to 17*size
+			extendedSize = 17 * (unsigned long long)size;
+			pos = 0;
+			for(j=0; pos<size; ++j){
+				if(generator.bounded(extendedSize - j) < (unsigned long long)(size - pos)){
+					arr[pos++] = range_min + (T)((double)j / extendedSize * (range_max - range_min));
+				}
+			}
+		}
+		//we got a sorted array in ascending order
+		if(sorted == DESCENDING){
+			std::reverse(arr, arr+size);
+		}else if(sorted == UNSORTED){
+			ShuffleArray(arr, size, generator);
+		}
+	}
+
+/**
+* same as above, drawing from the default generator
+*/
+template <typename T>
+	void FillRandomArray(T *arr, int size, T range_min=10, T range_max=50000, bool unique = false, int sorted=UNSORTED){
+		FillRandomArray(arr, size, range_min, range_max, unique, sorted, DefaultRandomGenerator());
+	}
+
+/**
+* fills a large array with random elements in the given range, using all the hardware threads by default.
+* the array is split in chunks of a fixed size, each with its own stream of the seed, so the result only
+* depends on the seed, whatever the number of threads
+*/
+template <typename T>
+	void FillRandomArrayParallel(T *arr, long long size, T range_min, T range_max, unsigned long long seed, int threads = 0){
+		const long long CHUNK_SIZE = 1 << 16;
+		long long nrChunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		std::atomic<long long> nextChunk(0);
+		std::vector<std::thread> workers;
+
+		if(range_min >= range_max){
+			throw "empty range";
+		}
+		if(threads <= 0){
+			threads = std::thread::hardware_concurrency() > 0 ? (int)std::thread::hardware_concurrency() : 1;
+		}
+		auto fillChunks = [&](){
+			long long chunk;
+			while((chunk = nextChunk++) < nrChunks){
+				RandomGenerator generator(seed, (unsigned long long)chunk);
+				long long end = (chunk + 1) * CHUNK_SIZE < size ? (chunk + 1) * CHUNK_SIZE : size;
+				for(long long i=chunk*CHUNK_SIZE; i<end; ++i){
+					arr[i] = RandomValue(generator, range_min, range_max);
+				}
+			}
+		};
+		for(int i=1; i<threads && i<nrChunks; ++i){
+			workers.push_back(std::thread(fillChunks));
+		}
+		fillChunks();
+		for(size_t i=0; i<workers.size(); ++i){
+			workers[i].join();
+		}
+	}
+
+/**
+* the distributions of the workloads that FillDistributedArray can generate
+*/
+enum Distribution { UNIFORM = 0, SORTED, REVERSED, ZIPF, NEARLY_SORTED, ORGAN_PIPE, SAWTOOTH, FEW_UNIQUE,
+					MANY_DUPLICATES, MEDIAN_OF_3_KILLER, GAUSSIAN, NR_DISTRIBUTIONS };
+
+inline const char *DistributionName(int distribution){
+	static const char *names[NR_DISTRIBUTIONS] = {"uniform", "sorted", "reversed", "zipf", "nearly-sorted", "organ-pipe",
+												  "sawtooth", "few-unique", "many-duplicates", "median-of-3-killer", "gaussian"};
+	return names[distribution];
+}
+
+inline int FindDistribution(const char *name){
+	for(int i=0; i<NR_DISTRIBUTIONS; ++i){
+		if(strcmp(name, DistributionName(i)) == 0){
+			return i;
+		}
+	}
+	throw "unknown distribution";
+}
+
+/**
+* fills the given array with elements in the given range, following a distribution:
+*	uniform, sorted, reversed	uniform values, in random, ascending or descending order
+*	zipf				min(range, size) keys, the r-th smallest drawn with probability proportional to 1 / r
+*	nearly-sorted			ascending, then size / 100 (at least 1) random swaps
+*	organ-pipe			ascending up to the middle, then descending
+*	sawtooth			sqrt(size) ascending runs of equally spaced values
+*	few-unique			8 random keys, drawn uniformly
+*	many-duplicates			sqrt(size) random keys, drawn uniformly
+*	median-of-3-killer		Musser's permutation that makes median of 3 quicksort quadratic
+*	gaussian			normal around the middle of the range, with a standard deviation of range / 8
+*/
+template <typename T>
+	void FillDistributedArray(T *arr, int size, int distribution, T range_min, T range_max, RandomGenerator &generator){
+		int i, k;
+		double interval = (double)range_max - (double)range_min;
+
+		if(range_min >= range_max){
+			throw "empty range";
+		}
+		if(size <= 0){
+			return;
+		}
+		switch(distribution){
+		case UNIFORM:
+		case SORTED:
+		case REVERSED:
+			FillRandomArray(arr, size, range_min, range_max, false,
+							distribution == SORTED ? ASCENDING : (distribution == REVERSED ? DESCENDING : UNSORTED), generator);
+			break;
+		case ZIPF:{
+			int keys = (std::is_floating_point<T>::value || interval + 1 > size) ? size : (int)interval + 1;
+			std::vector<double> harmonic(keys);
+			double sum = 0;
+			for(i=0; i<keys; ++i){
+				sum += 1.0 / (i + 1);
+				harmonic[i] = sum;
+			}
+			for(i=0; i<size; ++i){
+				int rank = (int)(std::upper_bound(harmonic.begin(), harmonic.end(), generator.uniform() * sum) - harmonic.begin());
+				arr[i] = range_min + (T)(keys > 1 ? rank * (interval / (keys - 1)) : 0);
+			}
+			break;
+		}
+		case NEARLY_SORTED:
+			FillRandomArray(arr, size, range_min, range_max, false, ASCENDING, generator);
+			for(k=size/100 > 1 ? size/100 : 1; k>0; --k){
+				// the order of the draws in the arguments of a call is unspecified, they are drawn first
+				size_t a = generator.bounded(size), b = generator.bounded(size);
+				std::swap(arr[a], arr[b]);
+			}
+			break;
+		case ORGAN_PIPE:{
+			std::vector<T> sorted(size);
+			FillRandomArray(&sorted[0], size, range_min, range_max, false, ASCENDING, generator);
+			// every other element goes up, the rest come back down
+			for(i=0; i<size; ++i){
+				arr[i % 2 ? size - 1 - i / 2 : i / 2] = sorted[i];
+			}
+			break;
+		}
+		case SAWTOOTH:{
+			int teeth = (int)sqrt((double)size) > 2 ? (int)sqrt((double)size) : 2;
+			int length = (size + teeth - 1) / teeth;
+			for(i=0; i<size; ++i){
+				arr[i] = range_min + (T)((i % length) * (interval / length));
+			}
+			break;
+		}
+		case FEW_UNIQUE:
+		case MANY_DUPLICATES:{
+			int keys = distribution == FEW_UNIQUE ? 8 : ((int)sqrt((double)size) > 1 ? (int)sqrt((double)size) : 1);
+			std::vector<T> values(keys);
+			for(i=0; i<keys; ++i){
+				values[i] = RandomValue(generator, range_min, range_max);
+			}
+			for(i=0; i<size; ++i){
+				arr[i] = values[generator.bounded(keys)];
+			}
+			break;
+		}
+		case MEDIAN_OF_3_KILLER:{
+			// a permutation of range_min + 0..size-1 (squeezed into the range if it holds fewer values, which then repeat):
+			// the sequence of Musser's introsort paper over the first 2k values, for the largest even k with 2k <= size
+			// (it is only a permutation for an even k), then the remaining values in order
+			double step = interval + 1 >= size ? 1 : interval / (size > 1 ? size - 1 : 1);
+			k = size / 2 - (size / 2) % 2;
+			for(i=1; i<=k; ++i){
+				if(i % 2){
+					arr[i - 1] = range_min + (T)((i - 1) * step);
+					arr[i] = range_min + (T)((k + i - 1) * step);
+				}
+				arr[k + i - 1] = range_min + (T)((2 * i - 1) * step);
+			}
+			for(i=2 * k; i<size; ++i){
+				arr[i] = range_min + (T)(i * step);
+			}
+			break;
+		}
+		case GAUSSIAN:{
+			double mean = (double)range_min + interval / 2, deviation = interval / 8;
+			for(i=0; i<size; ++i){
+				// Box-Muller transform, 1 - uniform() is never 0. the draws are named, the order in which the
+				// operands of an expression are evaluated is unspecified and would differ between the compilers
+				double u1 = generator.uniform(), u2 = generator.uniform();
+				double value = mean + deviation * sqrt(-2 * log(1 - u1)) * cos(2 * 3.14159265358979323846 * u2);
+				value = value < (double)range_min ? (double)range_min : (value > (double)range_max ? (double)range_max : value);
+				arr[i] = std::is_floating_point<T>::value ? (T)value : (T)floor(value + 0.5);
+			}
+			break;
+		}
+		default:
+			throw "unknown distribution";
+		}
+	}
+
+/**
+* same as above, with the distribution given by name, drawing from the default generator
+*/
+template <typename T>
+	void FillDistributedArray(T *arr, int size, const char *distribution, T range_min=10, T range_max=50000){
+		FillDistributedArray(arr, size, FindDistribution(distribution), range_min, range_max, DefaultRandomGenerator());
+	}
+
+template <typename T>
+	void CopyArray(T *dst, T *src, int size) {
+		memcpy(dst, src, size * sizeof(T));
+	}
+
+/**
+* Checks if the given array is sorted or not.
+*/
+template <typename T>
+	bool IsSorted(T *arr, int size){
+		int i;
+		for(i=1; i<size; ++i){
+			if(arr[i] < arr[i-1]){
+				return false;
+			}
+		}
+		return true;
+	}
+
+/**
+* an edge of a workload snapshot, the weight is 0 for the unweighted graphs
+*/
+struct SnapshotEdge{
+	int source, destination, weight;
+};
+
+/**
+* the inputs of a benchmark saved to a file, so that the same large workload can be replayed across algorithms
+* and machines without generating it again. the file is little endian and starts with a 64 byte header:
+*	"WKS1", u32 1 (the byte order), u64 offset of the directory, u32 number of entries
+* followed by the data of the entries, each aligned to 64 bytes so that it can be used in place once mapped:
+*	ARRAY		i32 values[count]
+*	SORTED_LISTS	u64 bounds[parameter + 1], i32 values[count]: list i is values[bounds[i]] to values[bounds[i + 1] - 1]
+*	EDGE_LIST	{i32 source, destination, weight}[count], parameter is the number of vertices
+*	PARENT_ARRAY	i32 parents[count], -1 for the roots
+* and by the directory, one record per entry:
+*	u32 kind, u32 name length, u64 offset, u64 count, u64 parameter, name padded with zeros to 8 bytes
+*/
+class WorkloadWriter{
+public:
+	enum Kind { ARRAY = 1, SORTED_LISTS, EDGE_LIST, PARENT_ARRAY };
+
+	static const int HEADER_SIZE = 64;
+	static const int ALIGNMENT = 64;
+
+	WorkloadWriter(const char *fileName) : offset(0){
+#ifdef _MSC_VER
+		fopen_s(&fout, fileName, "wb");
+#else
+		fout = fopen(fileName, "wb");
+#endif
+		if(!fout){
+			throw "could not open the workload file";
+		}
+		// the header is written again by close(), once the directory is known
+		static const char header[HEADER_SIZE] = {0};
+		write(header, HEADER_SIZE);
+	}
+
+	~WorkloadWriter(){
+		if(fout){
+			try{
+				close();
+			}catch(const char*){
+				// nothing can be reported from a destructor, the file is left incomplete
+			}
+		}
+	}
+
+	bool contains(const char *name) const{
+		for(size_t i=0; i<entries.size(); ++i){
+			if(entries[i].name == name){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void writeArray(const char *name, const int *values, size_t count){
+		beginEntry(name, ARRAY, count, 0);
+		write(values, count * sizeof(int));
+	}
+
+	/**
+	* k sorted lists, given one after the other in values: list i has lengths[i] elements
+	*/
+	void writeSortedLists(const char *name, const int *values, const int *lengths, int k){
+		std::vector<unsigned long long> bounds(k + 1, 0);
+		for(int i=0; i<k; ++i){
+			bounds[i + 1] = bounds[i] + lengths[i];
+		}
+		beginEntry(name, SORTED_LISTS, (size_t)bounds[k], k);
+		write(&bounds[0], bounds.size() * sizeof(bounds[0]));
+		write(values, (size_t)bounds[k] * sizeof(int));
+	}
+
+	void writeEdges(const char *name, int nrVertices, const SnapshotEdge *edges, size_t count){
+		beginEntry(name, EDGE_LIST, count, nrVertices);
+		write(edges, count * sizeof(SnapshotEdge));
+	}
+
+	void writeParents(const char *name, const int *parents, size_t count){
+		beginEntry(name, PARENT_ARRAY, count, 0);
+		write(parents, count * sizeof(int));
+	}
+
+	/**
+	* writes the directory and the header. the file is only valid once closed
+	*/
+	void close(){
+		unsigned long long directory;
+		pad(ALIGNMENT);
+		directory = offset;
+		for(size_t i=0; i<entries.size(); ++i){
+			static const char zeros[8] = {0};
+			writeInt(entries[i].kind, 4);
+			writeInt(entries[i].name.size(), 4);
+			writeInt(entries[i].offset, 8);
+			writeInt(entries[i].count, 8);
+			writeInt(entries[i].parameter, 8);
+			write(entries[i].name.c_str(), entries[i].name.size());
+			write(zeros, (8 - entries[i].name.size() % 8) % 8);
+		}
+		fseek(fout, 0, SEEK_SET);
+		write("WKS1", 4);
+		writeInt(1, 4);
+		writeInt(directory, 8);
+		writeInt(entries.size(), 4);
+		bool failed = ferror(fout) != 0;
+		failed = fclose(fout) != 0 || failed;
+		fout = NULL;
+		if(failed){
+			throw "could not write the workload file";
+		}
+	}
+
+private:
+	struct Entry{
+		std::string name;
+		unsigned int kind;
+		unsigned long long offset, count, parameter;
+	};
+
+	FILE *fout;
+	unsigned long long offset;
+	std::vector<Entry> entries;
+
+	void beginEntry(const char *name, Kind kind, size_t count, long long parameter){
+		if(contains(name)){
+			throw "the workload file already has an entry with this name";
+		}
+		pad(ALIGNMENT);
+		Entry entry;
+		entry.name = name;
+		entry.kind = kind;
+		entry.offset = offset;
+		entry.count = count;
+		entry.parameter = (unsigned long long)parameter;
+		entries.push_back(entry);
+	}
+
+	void write(const void *data, size_t bytes){
+		if(bytes > 0 && fwrite(data, 1, bytes, fout) != bytes){
+			throw "could not write the workload file";
+		}
+		offset += bytes;
+	}
+
+	void writeInt(unsigned long long value, int bytes){
+		unsigned char buffer[8];
+		for(int i=0; i<bytes; ++i){
+			buffer[i] = (unsigned char)((value >> (8 * i)) & 0xff);
+		}
+		write(buffer, bytes);
+	}
+
+	void pad(int alignment){
+		static const char zeros[ALIGNMENT] = {0};
+		write(zeros, (size_t)((alignment - offset % alignment) % alignment));
+	}
+
+	WorkloadWriter(const WorkloadWriter&);
+	WorkloadWriter& operator=(const WorkloadWriter&);
+};
+
+/**
+* reads a file written by WorkloadWriter. the file is mapped in memory and the entries are returned in place,
+* without copying them: they stay valid as long as the snapshot does, and are read only.
+* a machine of the other byte order cannot read the file
+*/
+class WorkloadSnapshot{
+public:
+	struct SortedLists{
+		int k;
+		// list i is values[bounds[i]] to values[bounds[i + 1] - 1]
+		const unsigned long long *bounds;
+		const int *values;
+	};
+
+	struct EdgeList{
+		int nrVertices;
+		size_t nrEdges;
+		const SnapshotEdge *edges;
+	};
+
+	WorkloadSnapshot(const char *fileName) : data(NULL), size(0){
+		map(fileName);
+		try{
+			readDirectory();
+		}catch(const char*){
+			unmap();
+			throw;
+		}
+	}
+
+	~WorkloadSnapshot(){
+		unmap();
+	}
+
+	bool contains(const char *name) const{
+		return entries.count(name) != 0;
+	}
+
+	const int *array(const char *name, size_t &count) const{
+		const Entry &entry = find(name, WorkloadWriter::ARRAY);
+		count = (size_t)entry.count;
+		return (const int*)(data + entry.offset);
+	}
+
+	SortedLists sortedLists(const char *name) const{
+		const Entry &entry = find(name, WorkloadWriter::SORTED_LISTS);
+		SortedLists lists;
+		lists.k = (int)entry.parameter;
+		lists.bounds = (const unsigned long long*)(data + entry.offset);
+		lists.values = (const int*)(lists.bounds + lists.k + 1);
+		return lists;
+	}
+
+	EdgeList edges(const char *name) const{
+		const Entry &entry = find(name, WorkloadWriter::EDGE_LIST);
+		EdgeList list;
+		list.nrVertices = (int)entry.parameter;
+		list.nrEdges = (size_t)entry.count;
+		list.edges = (const SnapshotEdge*)(data + entry.offset);
+		return list;
+	}
+
+	const int *parents(const char *name, size_t &count) const{
+		const Entry &entry = find(name, WorkloadWriter::PARENT_ARRAY);
+		count = (size_t)entry.count;
+		return (const int*)(data + entry.offset);
+	}
+
+private:
+	struct Entry{
+		unsigned int kind;
+		unsigned long long offset, count, parameter;
+	};
+
+	const char *data;
+	size_t size;
+	std::map<std::string, Entry> entries;
+#ifdef _MSC_VER
+	HANDLE file, mapping;
+#endif
+
+	const Entry &find(const char *name, WorkloadWriter::Kind kind) const{
+		std::map<std::string, Entry>::const_iterator it = entries.find(name);
+		if(it == entries.end()){
+			throw "the workload file has no entry with this name";
+		}
+		if(it->second.kind != (unsigned int)kind){
+			throw "the entry of the workload file has another kind";
+		}
+		return it->second;
+	}
+
+	unsigned long long readInt(size_t position, int bytes) const{
+		unsigned long long value = 0;
+		if(position + bytes > size){
+			throw "the workload file is corrupted";
+		}
+		for(int i=bytes-1; i>=0; --i){
+			value = (value << 8) | (unsigned char)data[position + i];
+		}
+		return value;
+	}
+
+	void readDirectory(){
+		if(size < (size_t)WorkloadWriter::HEADER_SIZE || memcmp(data, "WKS1", 4) != 0){
+			throw "not a workload file";
+		}
+		if(*(const unsigned int*)(data + 4) != 1){
+			throw "the workload file was written on a machine of the other byte order";
+		}
+		size_t position = (size_t)readInt(8, 8);
+		unsigned int nrEntries = (unsigned int)readInt(16, 4);
+		for(unsigned int i=0; i<nrEntries; ++i){
+			Entry entry;
+			entry.kind = (unsigned int)readInt(position, 4);
+			size_t nameLength = (size_t)readInt(position + 4, 4);
+			entry.offset = readInt(position + 8, 8);
+			entry.count = readInt(position + 16, 8);
+			entry.parameter = readInt(position + 24, 8);
+			if(position + 32 + nameLength > size || entry.offset < (unsigned long long)WorkloadWriter::HEADER_SIZE ||
+			   entry.offset > size || entry.offset + entryBytes(entry) > size){
+				throw "the workload file is corrupted";
+			}
+			entries[std::string(data + position + 32, nameLength)] = entry;
+			position += 32 + (nameLength + 7) / 8 * 8;
+		}
+	}
+
+	static unsigned long long entryBytes(const Entry &entry){
+		switch(entry.kind){
+		case WorkloadWriter::SORTED_LISTS:
+			return (entry.parameter + 1) * sizeof(unsigned long long) + entry.count * sizeof(int);
+		case WorkloadWriter::EDGE_LIST:
+			return entry.count * sizeof(SnapshotEdge);
+		default:
+			return entry.count * sizeof(int);
+		}
+	}
+
+	void map(const char *fileName){
+#ifdef _MSC_VER
+		LARGE_INTEGER fileSize;
+		file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(file == INVALID_HANDLE_VALUE){
+			throw "could not open the workload file";
+		}
+		mapping = NULL;
+		if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 ||
+		   !(mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)) ||
+		   !(data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0))){
+			if(mapping){
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			throw "could not map the workload file";
+		}
+		size = (size_t)fileSize.QuadPart;
+#else
+		struct stat status;
+		int fd = open(fileName, O_RDONLY);
+		if(fd < 0){
+			throw "could not open the workload file";
+		}
+		void *mapped = fstat(fd, &status) != 0 || status.st_size == 0 ? MAP_FAILED :
+						mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// the mapping stays valid without the descriptor
+		::close(fd);
+		if(mapped == MAP_FAILED){
+			throw "could not map the workload file";
+		}
+		data = (const char*)mapped;
+		size = (size_t)status.st_size;
+#endif
+	}
+
+	void unmap(){
+		if(!data){
+			return;
+		}
+#ifdef _MSC_VER
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+		CloseHandle(file);
+#else
+		munmap((void*)data, size);
+#endif
+		data = NULL;
+	}
+
+	WorkloadSnapshot(const WorkloadSnapshot&);
+	WorkloadSnapshot& operator=(const WorkloadSnapshot&);
+};
+
 #endif
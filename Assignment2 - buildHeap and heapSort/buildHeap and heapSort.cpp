@@ -14,7 +14,9 @@
  */
 
 #include <iostream>
+#ifdef _WIN32
 #include <conio.h>
+#endif
 #include "Profiler.h"
 
 #define MAX_SIZE 10000
@@ -81,8 +83,10 @@ int parent(int index) {
 	}
 }
 
-// inserts a new element in the given heap, updating the heaps' size
-void insertHeap(int *intArray, int *heapSize, int size, int keyToInsert, Operation* o) {
+// inserts a new element in the given heap, updating the heaps' size.
+// the array is an int * or a CountedArray<int>, which counts the accesses by itself (see the benchmark driver)
+template <typename Counter, typename Array>
+void insertHeap(Array intArray, int *heapSize, int size, int keyToInsert, Counter* o) {
 	// increase heap size
 	(*heapSize)++;
 	
@@ -112,7 +116,8 @@ void insertHeap(int *intArray, int *heapSize, int size, int keyToInsert, Operati
 }
 
 // given 2 heaps and a new element, creates one heap
-void heapify(int *intArray, int indexOfRoot, int size, Operation* o) {
+template <typename Counter, typename Array>
+void heapify(Array intArray, int indexOfRoot, int size, Counter* o) {
 	int largest = indexOfRoot, leftChild = indexOfRoot * 2 + 1, rightChild = indexOfRoot * 2 + 2; // 0 based array
 
 	// update index of the element with the largest value, if necessary
@@ -144,8 +149,9 @@ void heapify(int *intArray, int indexOfRoot, int size, Operation* o) {
 * Functions to build the heap
 */
 
-void buildHeapBottomUp(int *intArray, int size) {
-	Operation o = profiler.createOperation("operationsBottomUp", size);
+template <typename Counter = DefaultOperation, typename Array>
+void buildHeapBottomUp(Array intArray, int size) {
+	Counter o = profiler.createCounter<Counter>("operationsBottomUp", size);
 
 	// starting from the first parent, take it's children (leafs are heaps) and its index and use heapify to build a bigger heap
 	for (int indexOfRoot = size / 2 - 1; indexOfRoot >= 0; indexOfRoot--) {
@@ -153,8 +159,9 @@ void buildHeapBottomUp(int *intArray, int size) {
 	}
 }
 
-int buildHeapTopDown(int *intArray, int size) {
-	Operation o = profiler.createOperation("operationsTopDown", size);
+template <typename Counter = DefaultOperation, typename Array>
+int buildHeapTopDown(Array intArray, int size) {
+	Counter o = profiler.createCounter<Counter>("operationsTopDown", size);
 
 	// originally the size of the heap is 1, since the first element of the array is already a heap by itself
 	int heapSize = 1;
@@ -172,11 +179,12 @@ int buildHeapTopDown(int *intArray, int size) {
 * heap sort function using top down heap construction
 */
 
-void heapSort(int *intArray, int size) {
-	Operation o = profiler.createOperation("operationsHeapSort1", size);
+template <typename Counter = DefaultOperation, typename Array>
+void heapSort(Array intArray, int size) {
+	Counter o = profiler.createCounter<Counter>("operationsHeapSort1", size);
 
 	// build the heap. As a consequence, the element with the greatest value is placed at the root of the heap
-	buildHeapBottomUp(intArray, size);
+	buildHeapBottomUp<Counter>(intArray, size);
 	const int indexOfRoot = 0;
 
 	for (int i = size - 1; i >= 0; i--) {
@@ -191,30 +199,30 @@ void heapSort(int *intArray, int size) {
 	profiler.addSeries("operationsHeapSort", "operationsHeapSort1", "operationsBottomUp");
 }
 
-void averageCase(void) {
-	int baseArray[MAX_SIZE], intArray[MAX_SIZE], size, samples;
+// the distribution is one of the names known by FillDistributedArray
+void averageCase(const char *distribution = "uniform") {
+	int intArray[MAX_SIZE], size;
+	BenchmarkRunner runner(profiler);
 
 	for (size = 100; size <= MAX_SIZE; size += INCREMENT) {
-		// since we are in the average case, the number of experiments is > 1 and we take the mean value.
-		for (samples = 0; samples < 5; samples++) {
-			FillRandomArray(baseArray, size);
-
-			// we need to make a copy of the randomly generated array, since the construct heap fuctions alterate the array given as parameter 
-			CopyArray(intArray, baseArray, size);
-			buildHeapTopDown(intArray, size);
-			printError(intArray, size);
-
-			CopyArray(intArray, baseArray, size);
-			buildHeapBottomUp(intArray, size);
-			printError(intArray, size);
-		}
-	}
+		// since we are in the average case, every point is sampled until its mean is known well enough
+		// the check of the heap is done on the last sample only, so that it is not timed.
+		// the accesses are counted by CountedArray, the same way for both constructions, instead of the counts placed by hand
+		runner.runCounted("operationsTopDown", size, [&]() { FillDistributedArray(intArray, size, distribution); }, [&](CountedOperations<> &operations) {
+			buildHeapTopDown<NullOperation>(CountedArray<int>(intArray, operations), size);
+		});
+		printError(intArray, size);
 
-	// take the mean value
-	profiler.divideValues("operationsTopDown", 5);
-	profiler.divideValues("operationsBottomUp", 5);
+		runner.runCounted("operationsBottomUp", size, [&]() { FillDistributedArray(intArray, size, distribution); }, [&](CountedOperations<> &operations) {
+			buildHeapBottomUp<NullOperation>(CountedArray<int>(intArray, operations), size);
+		});
+		printError(intArray, size);
+	}
 
-	profiler.createGroup("heapConstructionComparisonAverage", "operationsTopDown", "operationsBottomUp");
+	profiler.createGroup("heapConstructionComparisonsAverage", "operationsTopDown_comparisons", "operationsBottomUp_comparisons");
+	profiler.createGroup("heapConstructionSwapsAverage", "operationsTopDown_swaps", "operationsBottomUp_swaps");
+	profiler.createGroup("heapConstructionAccessesAverage", "operationsTopDown_reads", "operationsBottomUp_reads",
+						 "operationsTopDown_writes", "operationsBottomUp_writes");
 
 	profiler.reset("Worst Case Evaluation");
 }
@@ -240,6 +248,8 @@ void worstCase(void) {
 	profiler.showReport();
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 int main(void) {
 	int intArray[MAX_SIZE], baseArray[MAX_SIZE];
 	
@@ -273,6 +283,9 @@ int main(void) {
 	worstCase();*/
 
 	std::cout << "\n\nPress any key to continue...";
+#ifdef _WIN32
 	_getch();
+#endif
 	return 0;
 }
+#endif
@@ -19,7 +19,9 @@
 
 #include <iostream>
 #include <ctime>
+#ifdef _WIN32
 #include <conio.h>
+#endif
 #include "Profiler.h"
 
 #define MAX_SIZE 10000
@@ -54,8 +56,10 @@ void printArray(int *intArray, int size)
 * Helper functions for quick sort
 */
 
-// used to eliminate the overhead needed for small arrays
-void insertionSort(int *intArray, int left, int right, Operation *o)
+// used to eliminate the overhead needed for small arrays.
+// the arrays of the sorts below are int * or CountedArray<int>, which counts the accesses by itself (see the benchmark driver)
+template <typename Counter, typename Array>
+void insertionSort(Array intArray, int left, int right, Counter *o)
 {
 	int temp = 0, j, i;
 	for (i = left + 1; i <= right; i++)
@@ -85,7 +89,8 @@ void insertionSort(int *intArray, int left, int right, Operation *o)
 }
 
 // main partitioning function. Patitions around the last element of the array
-int partition(int *intArray, int left, int right, Operation *o)
+template <typename Counter, typename Array>
+int partition(Array intArray, int left, int right, Counter *o)
 {
 	int pivot = intArray[right], pivotPos = left - 1;
 	o->count();
@@ -111,8 +116,299 @@ int partition(int *intArray, int left, int right, Operation *o)
 	return pivotPos;
 }
 
+// the partitions that quickSort and quickSortRandomized can use. the first two put the keys equal to the pivot on its left,
+// so an array of few distinct keys is sorted in O(n^2); the last two keep the keys equal to a pivot out of the recursion
+enum PartitionScheme { LOMUTO_PARTITION, BLOCK_PARTITION, THREE_WAY_PARTITION, DUAL_PIVOT_PARTITION };
+
+// the size of the blocks of blockPartition: 128 offsets of each side fit in 256 bytes of the L1 cache
+#define PARTITION_BLOCK 128
+
+// BlockQuicksort partitioning (Edelkamp and Weiss) around the last element of the array, with the same result as partition.
+// the comparisons of a block of elements from each end are done first, and their results only add up the offsets of the misplaced
+// elements, without a branch. the misplaced elements are then swapped in pairs, so the only branches left are the loops,
+// which are predictable, instead of the comparison with the pivot that is mispredicted half of the time on random data.
+// the rest that does not fill 2 blocks is split in 2 smaller blocks, so the small partitions have no such branch either
+template <typename Counter, typename Array>
+int blockPartition(Array intArray, int left, int right, Counter *o)
+{
+	unsigned char offsetsLeft[PARTITION_BLOCK], offsetsRight[PARTITION_BLOCK];
+	int pivot = intArray[right], l = left, r = right - 1;
+	int nrLeft = 0, nrRight = 0, startLeft = 0, startRight = 0;
+	o->count();
+
+	// everything before l is <= pivot, everything after r is > pivot
+	while (r - l + 1 > 2 * PARTITION_BLOCK)
+	{
+		// the offsets of the elements of the left block that are > pivot
+		if (nrLeft == 0)
+		{
+			startLeft = 0;
+			for (int i = 0; i < PARTITION_BLOCK; i++)
+			{
+				offsetsLeft[nrLeft] = (unsigned char)i;
+				nrLeft += intArray[l + i] > pivot;
+			}
+			o->count(PARTITION_BLOCK);
+		}
+		// the offsets of the elements of the right block that are <= pivot
+		if (nrRight == 0)
+		{
+			startRight = 0;
+			for (int i = 0; i < PARTITION_BLOCK; i++)
+			{
+				offsetsRight[nrRight] = (unsigned char)i;
+				nrRight += intArray[r - i] <= pivot;
+			}
+			o->count(PARTITION_BLOCK);
+		}
+
+		int nrSwaps = nrLeft < nrRight ? nrLeft : nrRight;
+		for (int i = 0; i < nrSwaps; i++)
+		{
+			swap(&intArray[l + offsetsLeft[startLeft + i]], &intArray[r - offsetsRight[startRight + i]]);
+		}
+		o->count(3 * nrSwaps);
+
+		// a block whose misplaced elements have all been swapped is done
+		nrLeft -= nrSwaps;
+		nrRight -= nrSwaps;
+		startLeft += nrSwaps;
+		startRight += nrSwaps;
+		if (nrLeft == 0)
+		{
+			l += PARTITION_BLOCK;
+		}
+		if (nrRight == 0)
+		{
+			r -= PARTITION_BLOCK;
+		}
+	}
+
+	// at most 2 blocks are left between l and r: what is not in the block still in progress (if any) becomes the other
+	// block, or, when both are done, the rest is split in two blocks of half its size, scanned with the same loops
+	int sizeLeft = PARTITION_BLOCK, sizeRight = PARTITION_BLOCK;
+	if (nrLeft == 0 && nrRight == 0)
+	{
+		sizeLeft = (r - l + 1) / 2;
+		sizeRight = r - l + 1 - sizeLeft;
+	}
+	else if (nrLeft == 0)
+	{
+		sizeLeft = r - l + 1 - PARTITION_BLOCK;
+	}
+	else
+	{
+		sizeRight = r - l + 1 - PARTITION_BLOCK;
+	}
+	if (nrLeft == 0)
+	{
+		startLeft = 0;
+		for (int i = 0; i < sizeLeft; i++)
+		{
+			offsetsLeft[nrLeft] = (unsigned char)i;
+			nrLeft += intArray[l + i] > pivot;
+		}
+		o->count(sizeLeft);
+	}
+	if (nrRight == 0)
+	{
+		startRight = 0;
+		for (int i = 0; i < sizeRight; i++)
+		{
+			offsetsRight[nrRight] = (unsigned char)i;
+			nrRight += intArray[r - i] <= pivot;
+		}
+		o->count(sizeRight);
+	}
+
+	int nrSwaps = nrLeft < nrRight ? nrLeft : nrRight;
+	for (int i = 0; i < nrSwaps; i++)
+	{
+		swap(&intArray[l + offsetsLeft[startLeft + i]], &intArray[r - offsetsRight[startRight + i]]);
+	}
+	o->count(3 * nrSwaps);
+	nrLeft -= nrSwaps;
+	nrRight -= nrSwaps;
+	startLeft += nrSwaps;
+	startRight += nrSwaps;
+	if (nrLeft == 0)
+	{
+		l += sizeLeft;
+	}
+	if (nrRight == 0)
+	{
+		r -= sizeRight;
+	}
+
+	// at most one block is not done, and it is all that is left between l and r: its misplaced elements are moved
+	// to its end next to the other side, from the last one (the elements already there stay), and the pivot goes between
+	int pivotPos = l;
+	if (nrLeft > 0)
+	{
+		int upper = r - l, last = startLeft + nrLeft - 1;
+		while (last >= startLeft && offsetsLeft[last] == upper)
+		{
+			last--;
+			upper--;
+		}
+		while (last >= startLeft)
+		{
+			swap(&intArray[l + upper], &intArray[l + offsetsLeft[last]]);
+			o->count(3);
+			last--;
+			upper--;
+		}
+		pivotPos = l + upper + 1;
+	}
+	else if (nrRight > 0)
+	{
+		int upper = r - l, last = startRight + nrRight - 1;
+		while (last >= startRight && offsetsRight[last] == upper)
+		{
+			last--;
+			upper--;
+		}
+		while (last >= startRight)
+		{
+			swap(&intArray[r - upper], &intArray[r - offsetsRight[last]]);
+			o->count(3);
+			last--;
+			upper--;
+		}
+		pivotPos = r - upper;
+	}
+
+	swap(&intArray[pivotPos], &intArray[right]);
+	o->count(3);
+
+	return pivotPos;
+}
+
+// partitions around the last element with one of the schemes that return a single pivot (lomuto or block)
+template <typename Counter, typename Array>
+int partition(Array intArray, int left, int right, Counter *o, PartitionScheme scheme)
+{
+	return scheme == BLOCK_PARTITION ? blockPartition(intArray, left, right, o) : partition(intArray, left, right, o);
+}
+
+// Dijkstra's Dutch national flag partitioning around the last element of the array: the elements < pivot are moved before
+// equalLeft, the elements > pivot after equalRight, and the ones in between are all equal to the pivot and already in place
+template <typename Counter, typename Array>
+void threeWayPartition(Array intArray, int left, int right, Counter *o, int *equalLeft, int *equalRight)
+{
+	int pivot = intArray[right], lt = left, i = left, gt = right;
+	o->count();
+
+	// [left, lt) < pivot, [lt, i) == pivot, [i, gt] not seen yet, (gt, right] > pivot
+	while (i <= gt)
+	{
+		if (intArray[i] < pivot)
+		{
+			swap(&intArray[lt], &intArray[i]);
+			o->count(3);
+			lt++;
+			i++;
+		}
+		else if (intArray[i] > pivot)
+		{
+			swap(&intArray[i], &intArray[gt]);
+			o->count(3);
+			// the second comparison
+			o->count();
+			gt--;
+		}
+		else
+		{
+			i++;
+			o->count();
+		}
+
+		o->count();
+	}
+
+	*equalLeft = lt;
+	*equalRight = gt;
+}
+
+// Yaroslavskiy's dual pivot partitioning around the first and the last element of the array (the smaller one is the first pivot).
+// the elements < first pivot end up before lowPivot, the elements >= second pivot after highPivot, and the rest between them.
+// if the two pivots are equal, there would be nothing between them and all the keys equal to them would go to the right,
+// so the array is partitioned three ways instead: everything between lowPivot and highPivot is then equal to the pivots
+template <typename Counter, typename Array>
+void dualPivotPartition(Array intArray, int left, int right, Counter *o, int *lowPivot, int *highPivot)
+{
+	if (intArray[left] > intArray[right])
+	{
+		swap(&intArray[left], &intArray[right]);
+		o->count(3);
+	}
+	o->count();
+
+	int p = intArray[left], q = intArray[right];
+	o->count(2);
+	if (p == q)
+	{
+		threeWayPartition(intArray, left, right, o, lowPivot, highPivot);
+		return;
+	}
+
+	// [left + 1, l) < p, [l, k) between the pivots, [k, g] not seen yet, (g, right - 1] >= q
+	int l = left + 1, k = left + 1, g = right - 1;
+	while (k <= g)
+	{
+		if (intArray[k] < p)
+		{
+			swap(&intArray[k], &intArray[l]);
+			o->count(3);
+			l++;
+		}
+		else if (intArray[k] >= q)
+		{
+			o->count();
+			// skip the elements at the end that are already on the right side
+			while (intArray[g] > q && k < g)
+			{
+				g--;
+				o->count();
+			}
+			o->count();
+
+			swap(&intArray[k], &intArray[g]);
+			o->count(3);
+			g--;
+
+			// the element brought from the end can belong to the left part
+			if (intArray[k] < p)
+			{
+				swap(&intArray[k], &intArray[l]);
+				o->count(3);
+				l++;
+			}
+			o->count();
+		}
+		else
+		{
+			o->count();
+		}
+
+		o->count();
+		k++;
+	}
+
+	// put the pivots between the parts
+	l--;
+	g++;
+	swap(&intArray[left], &intArray[l]);
+	swap(&intArray[right], &intArray[g]);
+	o->count(6);
+
+	*lowPivot = l;
+	*highPivot = g;
+}
+
 // better partitioning because the worst case is avoided.
-int randomizedPartition(int *intArray, int left, int right, Operation *o)
+template <typename Counter, typename Array>
+int randomizedPartition(Array intArray, int left, int right, Counter *o, PartitionScheme scheme = LOMUTO_PARTITION)
 {
 	// choose a random index
 	int pivot = rand() % (right - left) + left;
@@ -122,15 +418,38 @@ int randomizedPartition(int *intArray, int left, int right, Operation *o)
 	o->count(3);
 
 	// now, the randomly selected pivot is the last element in the array, so we can call partitioni on it
-	return partition(intArray, left, right, o);
+	return partition(intArray, left, right, o, scheme);
+}
+
+// three way partitioning around a random element
+template <typename Counter, typename Array>
+void randomizedThreeWayPartition(Array intArray, int left, int right, Counter *o, int *equalLeft, int *equalRight)
+{
+	swap(&intArray[rand() % (right - left) + left], &intArray[right]);
+	o->count(3);
+
+	threeWayPartition(intArray, left, right, o, equalLeft, equalRight);
+}
+
+// dual pivot partitioning around two random elements, moved to the ends of the array
+template <typename Counter, typename Array>
+void randomizedDualPivotPartition(Array intArray, int left, int right, Counter *o, int *lowPivot, int *highPivot)
+{
+	swap(&intArray[rand() % (right - left) + left], &intArray[left]);
+	swap(&intArray[rand() % (right - left) + left + 1], &intArray[right]);
+	o->count(6);
+
+	dualPivotPartition(intArray, left, right, o, lowPivot, highPivot);
 }
 
 /**
 * Helper functions for heap construction
 */
 
-// given 2 heaps and a new element, creates one heap
-void heapify(int *intArray, int indexOfRoot, int size, Operation *o)
+// given 2 heaps and a new element, creates one heap.
+// the array can also be a SimulatedArray<int>, to count the cache misses of the heap
+template <typename Counter, typename Array>
+void heapify(Array intArray, int indexOfRoot, int size, Counter *o)
 {
 	int largest = indexOfRoot, leftChild = indexOfRoot * 2 + 1, rightChild = indexOfRoot * 2 + 2; // 0 based array
 
@@ -168,7 +487,8 @@ void heapify(int *intArray, int indexOfRoot, int size, Operation *o)
 * Functions to build the heap
 */
 
-void buildHeapBottomUp(int *intArray, int size, Operation *o)
+template <typename Counter, typename Array>
+void buildHeapBottomUp(Array intArray, int size, Counter *o)
 {
 	// starting from the first parent, take it's children (leafs are heaps) and its index and use heapify to build a bigger heap
 	for (int indexOfRoot = size / 2 - 1; indexOfRoot >= 0; indexOfRoot--)
@@ -181,14 +501,20 @@ void buildHeapBottomUp(int *intArray, int size, Operation *o)
 * Functions for the 2 main sorting algorithms
 */
 
-void heapSort(int *intArray, int size)
+template <typename Counter = DefaultOperation, typename Array>
+void heapSort(Array intArray, int size)
 {
-	Operation o = profiler.createOperation("operationsHeapSort", size);
+	Counter o = profiler.createCounter<Counter>("operationsHeapSort", size);
+	Scope heapSortScope(profiler, "heapSort", size, &o);
 
 	// build the heap. As a consequence, the element with the greatest value is placed at the root of the heap
-	buildHeapBottomUp(intArray, size, &o);
+	{
+		Scope phase(profiler, "buildHeapBottomUp", size, &o);
+		buildHeapBottomUp(intArray, size, &o);
+	}
 	const int indexOfRoot = 0;
 
+	Scope phase(profiler, "extractMaximum", size, &o);
 	for (int i = size - 1; i >= 0; i--)
 	{
 		// put the maximum element in its final position (as last element in the array) by swapping it with the last element in the array
@@ -201,7 +527,8 @@ void heapSort(int *intArray, int size)
 }
 
 // quicksort with partitioning around the last element in the array (can enter the O(n^2) worst case)
-void quickSort(int *intArray, int left, int right, Operation *o)
+template <typename Counter, typename Array>
+void quickSort(Array intArray, int left, int right, Counter *o, PartitionScheme scheme = LOMUTO_PARTITION)
 {
 	// if the length of the array is less than 1, there is nothing to sort (we avoid useless overhead)
 	if (right - left + 1 <= 1)
@@ -213,19 +540,43 @@ void quickSort(int *intArray, int left, int right, Operation *o)
 	{
 		insertionSort(intArray, left, right, o);
 	}
+	// the keys equal to the pivot are in their final place, only the smaller and the greater ones are left to sort
+	else if (scheme == THREE_WAY_PARTITION)
+	{
+		int equalLeft, equalRight;
+		threeWayPartition(intArray, left, right, o, &equalLeft, &equalRight);
+
+		quickSort(intArray, left, equalLeft - 1, o, scheme);
+		quickSort(intArray, equalRight + 1, right, o, scheme);
+	}
+	// three parts around two pivots. the middle one needs no sort if the pivots are equal: it only holds their key
+	else if (scheme == DUAL_PIVOT_PARTITION)
+	{
+		int lowPivot, highPivot;
+		dualPivotPartition(intArray, left, right, o, &lowPivot, &highPivot);
+
+		quickSort(intArray, left, lowPivot - 1, o, scheme);
+		if (intArray[lowPivot] != intArray[highPivot])
+		{
+			quickSort(intArray, lowPivot + 1, highPivot - 1, o, scheme);
+		}
+		o->count();
+		quickSort(intArray, highPivot + 1, right, o, scheme);
+	}
 	else
 	{
 		// put the pivot in its right place in the sorted array and return its position
-		int pivot = partition(intArray, left, right, o);
+		int pivot = partition(intArray, left, right, o, scheme);
 
 		// recursively sort the elements to the left and right of the pivot
-		quickSort(intArray, left, pivot - 1, o);
-		quickSort(intArray, pivot + 1, right, o);
+		quickSort(intArray, left, pivot - 1, o, scheme);
+		quickSort(intArray, pivot + 1, right, o, scheme);
 	}
 }
 
 // quicksort with partitioning around a random element of the array (avoids the O(n^2) worst case)
-void quickSortRandomized(int *intArray, int left, int right, Operation *o)
+template <typename Counter, typename Array>
+void quickSortRandomized(Array intArray, int left, int right, Counter *o, PartitionScheme scheme = LOMUTO_PARTITION)
 {
 	// if the length of the array is less than 1, there is nothing to sort (we avoid useless overhead)
 	if (right - left + 1 <= 1)
@@ -237,21 +588,333 @@ void quickSortRandomized(int *intArray, int left, int right, Operation *o)
 	{
 		insertionSort(intArray, left, right, o);
 	}
+	else if (scheme == THREE_WAY_PARTITION)
+	{
+		int equalLeft, equalRight;
+		randomizedThreeWayPartition(intArray, left, right, o, &equalLeft, &equalRight);
+
+		quickSortRandomized(intArray, left, equalLeft - 1, o, scheme);
+		quickSortRandomized(intArray, equalRight + 1, right, o, scheme);
+	}
+	else if (scheme == DUAL_PIVOT_PARTITION)
+	{
+		int lowPivot, highPivot;
+		randomizedDualPivotPartition(intArray, left, right, o, &lowPivot, &highPivot);
+
+		quickSortRandomized(intArray, left, lowPivot - 1, o, scheme);
+		if (intArray[lowPivot] != intArray[highPivot])
+		{
+			quickSortRandomized(intArray, lowPivot + 1, highPivot - 1, o, scheme);
+		}
+		o->count();
+		quickSortRandomized(intArray, highPivot + 1, right, o, scheme);
+	}
 	else
 	{
 		// put the pivot in its right place in the sorted array and return its position
-		int pivot = randomizedPartition(intArray, left, right, o);
+		int pivot = randomizedPartition(intArray, left, right, o, scheme);
 
 		// recursively sort the elements to the left and right of the pivot
-		quickSortRandomized(intArray, left, pivot - 1, o);
-		quickSortRandomized(intArray, pivot + 1, right, o);
+		quickSortRandomized(intArray, left, pivot - 1, o, scheme);
+		quickSortRandomized(intArray, pivot + 1, right, o, scheme);
+	}
+}
+
+/**
+* Helper functions for the adaptive quick sort
+*/
+
+// the subarrays of at most this many elements are left to insertionSort
+#define ADAPTIVE_INSERTION_CUTOFF 24
+// above this size the pivot is the median of 3 medians of 3 (Tukey's ninther) instead of the median of 3
+#define NINTHER_THRESHOLD 128
+// the number of moves after which partialInsertionSort gives up
+#define PARTIAL_INSERTION_LIMIT 8
+
+// heapSort of [left, right] with the given counter: the fallback of quickSortAdaptive, O(nlogn) whatever the input
+template <typename Counter, typename Array>
+void heapSortRange(Array intArray, int left, int right, Counter *o)
+{
+	Array subArray = intArray + left;
+	int size = right - left + 1;
+
+	buildHeapBottomUp(subArray, size, o);
+	for (int i = size - 1; i > 0; i--)
+	{
+		swap(&subArray[0], &subArray[i]);
+		o->count(3);
+
+		heapify(subArray, 0, i, o);
+	}
+}
+
+// insertionSort that gives up once it has moved more than PARTIAL_INSERTION_LIMIT elements. returns true if the array is sorted,
+// which costs O(n) on an array that was already (nearly) sorted, and at most O(n) wasted work otherwise
+template <typename Counter, typename Array>
+bool partialInsertionSort(Array intArray, int left, int right, Counter *o)
+{
+	int temp, j, moves = 0;
+	for (int i = left + 1; i <= right; i++)
+	{
+		if (moves > PARTIAL_INSERTION_LIMIT)
+		{
+			return false;
+		}
+
+		temp = intArray[i];
+		j = i - 1;
+		while (j >= left && temp < intArray[j])
+		{
+			intArray[j + 1] = intArray[j];
+			j--;
+			o->count(2);
+		}
+		if (j >= left)
+		{
+			o->count();
+		}
+
+		intArray[j + 1] = temp;
+		o->count(2);
+		moves += i - j - 1;
+	}
+
+	return true;
+}
+
+// orders the elements at positions a, b and c
+template <typename Counter, typename Array>
+void sort3(Array intArray, int a, int b, int c, Counter *o)
+{
+	if (intArray[b] < intArray[a])
+	{
+		swap(&intArray[a], &intArray[b]);
+		o->count(3);
+	}
+	if (intArray[c] < intArray[b])
+	{
+		swap(&intArray[b], &intArray[c]);
+		o->count(3);
+
+		if (intArray[b] < intArray[a])
+		{
+			swap(&intArray[a], &intArray[b]);
+			o->count(3);
+		}
+		o->count();
 	}
+	o->count(2);
+}
+
+// Hoare style partitioning around the FIRST element of the array, the median chosen by quickSortAdaptive (an element >= pivot
+// is after it, so the scans need no bounds checks). the elements equal to the pivot go to its right. alreadyPartitioned
+// is set if no element had to be swapped, which is the sign of an input that is already (nearly) sorted
+template <typename Counter, typename Array>
+int partitionRight(Array intArray, int left, int right, Counter *o, bool *alreadyPartitioned)
+{
+	int pivot = intArray[left], first = left, last = right + 1;
+	o->count();
+
+	// the first element >= pivot, and the last element < pivot
+	do { first++; o->count(); } while (intArray[first] < pivot);
+	if (first - 1 == left)
+	{
+		// nothing stops the scan from the right in this case but first
+		while (first < last)
+		{
+			last--;
+			o->count();
+			if (intArray[last] < pivot)
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		do { last--; o->count(); } while (!(intArray[last] < pivot));
+	}
+
+	*alreadyPartitioned = first >= last;
+
+	// swap the pairs of misplaced elements until the scans meet
+	while (first < last)
+	{
+		swap(&intArray[first], &intArray[last]);
+		o->count(3);
+		do { first++; o->count(); } while (intArray[first] < pivot);
+		do { last--; o->count(); } while (!(intArray[last] < pivot));
+	}
+
+	// put the pivot in its right place
+	int pivotPos = first - 1;
+	intArray[left] = intArray[pivotPos];
+	intArray[pivotPos] = pivot;
+	o->count(2);
+
+	return pivotPos;
+}
+
+// the same partitioning, with the elements equal to the pivot on its LEFT. quickSortAdaptive uses it when the pivot is equal
+// to the pivot of the partition before, which is then smaller than or equal to every element: all the elements that end up
+// on the left are equal to the pivot, and are done
+template <typename Counter, typename Array>
+int partitionLeft(Array intArray, int left, int right, Counter *o)
+{
+	int pivot = intArray[left], first = left, last = right + 1;
+	o->count();
+
+	do { last--; o->count(); } while (pivot < intArray[last]);
+	if (last == right)
+	{
+		while (first < last)
+		{
+			first++;
+			o->count();
+			if (pivot < intArray[first])
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		do { first++; o->count(); } while (!(pivot < intArray[first]));
+	}
+
+	while (first < last)
+	{
+		swap(&intArray[first], &intArray[last]);
+		o->count(3);
+		do { last--; o->count(); } while (pivot < intArray[last]);
+		do { first++; o->count(); } while (!(pivot < intArray[first]));
+	}
+
+	intArray[left] = intArray[last];
+	intArray[last] = pivot;
+	o->count(2);
+
+	return last;
+}
+
+// swaps a few elements of a part that came out of a bad partition with elements a quarter of the way in, so that the
+// pattern of the input that made the pivots bad is not there anymore when the part is partitioned
+template <typename Counter, typename Array>
+void breakPatterns(Array intArray, int left, int right, Counter *o)
+{
+	int size = right - left + 1, quarter = size / 4;
+
+	if (size < ADAPTIVE_INSERTION_CUTOFF)
+	{
+		return;
+	}
+
+	swap(&intArray[left], &intArray[left + quarter]);
+	swap(&intArray[right], &intArray[right - quarter]);
+	o->count(6);
+	if (size > NINTHER_THRESHOLD)
+	{
+		swap(&intArray[left + 1], &intArray[left + quarter + 1]);
+		swap(&intArray[left + 2], &intArray[left + quarter + 2]);
+		swap(&intArray[right - 1], &intArray[right - quarter - 1]);
+		swap(&intArray[right - 2], &intArray[right - quarter - 2]);
+		o->count(12);
+	}
+}
+
+// the loop of quickSortAdaptive: sorts [left, right], and allows badAllowed more highly unbalanced partitions before heapSort
+// finishes the array. leftmost is false if the element before left is the pivot of an earlier partition
+template <typename Counter, typename Array>
+void quickSortAdaptive(Array intArray, int left, int right, Counter *o, int badAllowed, bool leftmost)
+{
+	while (true)
+	{
+		int size = right - left + 1;
+
+		if (size <= ADAPTIVE_INSERTION_CUTOFF)
+		{
+			insertionSort(intArray, left, right, o);
+			return;
+		}
+
+		// the pivot is moved to the first position
+		int middle = left + size / 2;
+		if (size > NINTHER_THRESHOLD)
+		{
+			sort3(intArray, left, middle, right, o);
+			sort3(intArray, left + 1, middle - 1, right - 1, o);
+			sort3(intArray, left + 2, middle + 1, right - 2, o);
+			sort3(intArray, middle - 1, middle, middle + 1, o);
+			swap(&intArray[left], &intArray[middle]);
+			o->count(3);
+		}
+		else
+		{
+			sort3(intArray, middle, left, right, o);
+		}
+
+		// many keys equal to the pivot of the partition before: they are put aside in one pass, and only the greater keys are left
+		if (!leftmost && !(intArray[left - 1] < intArray[left]))
+		{
+			o->count();
+			left = partitionLeft(intArray, left, right, o) + 1;
+			continue;
+		}
+		if (!leftmost)
+		{
+			o->count();
+		}
+
+		bool alreadyPartitioned;
+		int pivot = partitionRight(intArray, left, right, o, &alreadyPartitioned);
+		int leftSize = pivot - left, rightSize = right - pivot;
+
+		if (leftSize < size / 8 || rightSize < size / 8)
+		{
+			// too many bad pivots: the input is adversarial, heapSort keeps the whole sort in O(nlogn)
+			if (--badAllowed == 0)
+			{
+				heapSortRange(intArray, left, right, o);
+				return;
+			}
+			breakPatterns(intArray, left, pivot - 1, o);
+			breakPatterns(intArray, pivot + 1, right, o);
+		}
+		// a balanced partition that swapped nothing: the input was probably sorted, and insertionSort finishes it in O(n)
+		else if (alreadyPartitioned && partialInsertionSort(intArray, left, pivot - 1, o)
+				 && partialInsertionSort(intArray, pivot + 1, right, o))
+		{
+			return;
+		}
+
+		// recursion on the left part, the loop goes on with the right part
+		quickSortAdaptive(intArray, left, pivot - 1, o, badAllowed, leftmost);
+		left = pivot + 1;
+		leftmost = false;
+	}
+}
+
+// pattern-defeating quicksort (Orson Peters' pdqsort): quickSort that adapts to its input. it takes the median of 3 (or
+// of 9) elements as pivot, finishes the sorted and nearly sorted parts with insertionSort in O(n), puts the runs of equal keys
+// aside in one pass, shuffles the parts that come out of bad partitions, and switches to heapSort after log2(n) of them.
+// sorted, reversed and sawtooth inputs take O(n) or close to it instead of O(n^2), and no input takes more than O(nlogn)
+template <typename Counter, typename Array>
+void quickSortAdaptive(Array intArray, int left, int right, Counter *o)
+{
+	int badAllowed = 1;
+	for (int size = right - left + 1; size > 1; size >>= 1)
+	{
+		badAllowed++;
+	}
+
+	quickSortAdaptive(intArray, left, right, o, badAllowed, true);
 }
 
 // selects the ith greatest element of the array in O(n) time
+template <typename Counter = DefaultOperation>
 int quickSelect(int *intArray, int left, int right, int pos)
 {
-	Operation o = profiler.createOperation("quickSelectOperations", right - left + 1);
+	Counter o = profiler.createCounter<Counter>("quickSelectOperations", right - left + 1);
 
 	// if there is only one element in the array, return it
 	if (left == right)
@@ -272,58 +935,67 @@ int quickSelect(int *intArray, int left, int right, int pos)
 	// if the position is less than the position of the pivot, we need to search in the left side (smaller elements)
 	else if (pos < nrElementsLeft)
 	{
-		return quickSelect(intArray, left, pivotRelativePos - 1, pos);
+		return quickSelect<Counter>(intArray, left, pivotRelativePos - 1, pos);
 	}
 	// otherwise we need to search on the right side, but taking all the elements to the left out of the equation. Hence, we are searching for pos - nrElemLeft
 	else
 	{
-		return quickSelect(intArray, pivotRelativePos + 1, right, pos - nrElementsLeft);
+		return quickSelect<Counter>(intArray, pivotRelativePos + 1, right, pos - nrElementsLeft);
 	}
 }
 
-void averageCase(void)
+// the distribution is one of the names known by FillDistributedArray
+void averageCase(const char *distribution = "uniform")
 {
-	int baseArray[MAX_SIZE], intArray[MAX_SIZE], size, samples;
+	int intArray[MAX_SIZE], size;
+	BenchmarkRunner runner(profiler);
 
 	for (size = 100; size <= MAX_SIZE; size += INCREMENT)
 	{
-		Operation o = profiler.createOperation("operationsQuickSort", size);
-		// since we are in the average case, the number of experiments is > 1 and we take the mean value.
-		for (samples = 0; samples < 5; samples++)
+		// since we are in the average case, every point is sampled until its mean is known well enough.
+		// the accesses are counted by CountedArray, the same way for both sorts, instead of the counts placed by hand
+		runner.runCounted("operationsHeapSort", size, [&]() { FillDistributedArray(intArray, size, distribution); }, [&](CountedOperations<> &operations)
 		{
-			FillRandomArray(baseArray, size);
-
-			// we need to make a copy of the randomly generated array, since the construct heap fuctions alterate the array given as parameter
-			CopyArray(intArray, baseArray, size);
-			heapSort(intArray, size);
+			heapSort<NullOperation>(CountedArray<int>(intArray, operations), size);
+		});
 
-			CopyArray(intArray, baseArray, size);
-			quickSortRandomized(intArray, 0, size - 1, &o);
-		}
+		runner.runCounted("operationsQuickSort", size, [&]() { FillDistributedArray(intArray, size, distribution); }, [&](CountedOperations<> &operations)
+		{
+			NullOperation o = profiler.createCounter<NullOperation>("operationsQuickSort", size);
+			quickSortRandomized(CountedArray<int>(intArray, operations), 0, size - 1, &o);
+		});
 	}
 
-	// take the mean value
-	profiler.divideValues("operationsHeapSort", 5);
-	profiler.divideValues("operationsQuickSort", 5);
+	profiler.createGroup("Average Case Comparisons", "operationsHeapSort_comparisons", "operationsQuickSort_comparisons");
+	profiler.createGroup("Average Case Swaps", "operationsHeapSort_swaps", "operationsQuickSort_swaps");
+	profiler.createGroup("Average Case Accesses", "operationsHeapSort_reads", "operationsQuickSort_reads",
+						 "operationsHeapSort_writes", "operationsQuickSort_writes");
 
-	profiler.createGroup("Average Case", "operationsHeapSort", "operationsQuickSort");
+	// both sorts are claimed to be O(nlogn) in the average case
+	ComplexityAnalysis analysis(profiler);
+	analysis.verify("operationsHeapSort_comparisons", Profiler::OPCOUNT, ComplexityAnalysis::N_LOG_N);
+	analysis.verify("operationsQuickSort_comparisons", Profiler::OPCOUNT, ComplexityAnalysis::N_LOG_N);
 
 	profiler.reset("Worst Case Evaluation");
 }
 
 void worstCase(void)
 {
-	int baseArray[MAX_SIZE], size;
+	int baseArray[MAX_SIZE], intArray[MAX_SIZE], size;
 
 	for (size = 100; size <= MAX_SIZE; size += INCREMENT)
 	{
-		Operation o = profiler.createOperation("operationsQuickSort", size);
+		DefaultOperation o = profiler.createCounter<DefaultOperation>("operationsQuickSort", size);
+		DefaultOperation adaptive = profiler.createCounter<DefaultOperation>("operationsQuickSortAdaptive", size);
 
+		// the same sorted input for the adaptive quicksort, which finishes it with insertionSort in O(n)
 		FillRandomArray(baseArray, size, 0, 50000, true, 1);
+		CopyArray(intArray, baseArray, size);
 		quickSort(baseArray, 0, size - 1, &o);
+		quickSortAdaptive(intArray, 0, size - 1, &adaptive);
 	}
 
-	profiler.createGroup("Worst Case quickSort", "operationsQuickSort");
+	profiler.createGroup("Worst Case quickSort", "operationsQuickSort", "operationsQuickSortAdaptive");
 
 	profiler.reset("Best Case Evaluation");
 }
@@ -352,7 +1024,7 @@ void bestCase(void)
 
 	for (size = 100; size <= MAX_SIZE; size += INCREMENT)
 	{
-		Operation o = profiler.createOperation("operationsQuickSort", size);
+		DefaultOperation o = profiler.createCounter<DefaultOperation>("operationsQuickSort", size);
 
 		FillRandomArray(baseArray, size, 0, 50000, true, 1);
 		generateBestCaseArray(baseArray, 0, size - 1);
@@ -364,12 +1036,15 @@ void bestCase(void)
 	profiler.showReport();
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 int main(void)
 {
     srand(time(NULL));
+	profiler.enableHardwareCounters();
 
     int intArray[MAX_SIZE], baseArray[MAX_SIZE];
-	Operation o = profiler.createOperation("operationsQuickSort", 100);
+	DefaultOperation o = profiler.createCounter<DefaultOperation>("operationsQuickSort", 100);
 
 	FillRandomArray(baseArray, 10, 0, 100);
 	std::cout << "The initial array: ";
@@ -391,6 +1066,11 @@ int main(void)
 	std::cout << "Sorted using quickSort (Randomized): ";
 	printArray(intArray, 10);
 
+	CopyArray(intArray, baseArray, 10);
+	quickSortAdaptive(intArray, 0, 9, &o);
+	std::cout << "Sorted using quickSort (Adaptive): ";
+	printArray(intArray, 10);
+
 	CopyArray(intArray, baseArray, 10);
 	std::cout << "4th element in the array (quickSelectRandomized): " << quickSelect(intArray, 0, 9, 4);
 
@@ -406,6 +1086,9 @@ int main(void)
 	bestCase();*/
 
 	std::cout << "\n\nPress any key to continue...";
+#ifdef _WIN32
 	_getch();
+#endif
 	return 0;
 }
+#endif
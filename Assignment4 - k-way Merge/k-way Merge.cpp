@@ -53,7 +53,7 @@ void swap(NodeT **x, NodeT **y) {
 
 // allocates and instantiates a new list
 ListT *createListHead(void) {
-	ListT *newList = (ListT*)malloc(sizeof(ListT));
+	ListT *newList = (ListT*)TrackedMalloc(sizeof(ListT));
 
 	if (newList) {
 		newList->first = newList->last = NULL;
@@ -69,7 +69,7 @@ ListT *createListHead(void) {
 
 // allocates and instantiates a new node
 NodeT *createNode(int value) {
-	NodeT *newNode = (NodeT*)malloc(sizeof(NodeT));
+	NodeT *newNode = (NodeT*)TrackedMalloc(sizeof(NodeT));
 	
 	if (newNode) {
 		newNode->value = value;
@@ -123,7 +123,7 @@ void deallocateList(ListT *listRef) {
 	while (listRef->first) {
 		current = listRef->first;
 		listRef->first = listRef->first->next;
-		free(current);
+		TrackedFree(current);
 	}
 
 	listRef->first = listRef->last = NULL;
@@ -140,8 +140,18 @@ int parent(int index) {
 	}
 }
 
-// inserts a new element in the given heap, updating the heaps' size
-void insertHeap(NodeT *nodeArray[], int *heapSize, int size, NodeT *keyToInsert, Operation* o) {
+// the order of the min heap: the nodes are compared by their values
+struct NodeLess {
+	bool operator()(NodeT *a, NodeT *b) const {
+		return a->value < b->value;
+	}
+};
+
+// inserts a new element in the given heap, updating the heaps' size.
+// the heap is a NodeT *[] compared with NodeLess, or a CountedArray<NodeT*> compared with a CountedCompare,
+// which count the accesses and the comparisons by themselves (see the benchmark driver)
+template <typename Counter, typename Array, typename Less>
+void insertHeap(Array nodeArray, int *heapSize, int size, NodeT *keyToInsert, Less less, Counter* o) {
 	// increase heap size
 	(*heapSize)++;
 
@@ -157,8 +167,8 @@ void insertHeap(NodeT *nodeArray[], int *heapSize, int size, NodeT *keyToInsert,
 
 	int i = (*heapSize) - 1;
 
-	// as long as the value in the new item is greater thant the value of its parent, swap them
-	while (i > 0 && nodeArray[parent(i)]->value > nodeArray[i]->value) {
+	// as long as the value in the new item is smaller than the value of its parent, swap them
+	while (i > 0 && less(nodeArray[i], nodeArray[parent(i)])) {
 		swap(&nodeArray[parent(i)], &nodeArray[i]);
 		i = parent(i);
 
@@ -171,11 +181,12 @@ void insertHeap(NodeT *nodeArray[], int *heapSize, int size, NodeT *keyToInsert,
 }
 
 // given 2 heaps and a new element, creates one heap
-void heapify(NodeT *nodeArray[], int indexOfRoot, int size, Operation* o) {
+template <typename Counter, typename Array, typename Less>
+void heapify(Array nodeArray, int indexOfRoot, int size, Less less, Counter* o) {
 	int largest = indexOfRoot, leftChild = indexOfRoot * 2 + 1, rightChild = indexOfRoot * 2 + 2; // 0 based array
 
 	// update index of the element with the largest value, if necessary
-	if (leftChild < size && nodeArray[leftChild]->value < nodeArray[largest]->value) {
+	if (leftChild < size && less(nodeArray[leftChild], nodeArray[largest])) {
 		largest = leftChild;
 	}
 	if (leftChild < size) {
@@ -183,7 +194,7 @@ void heapify(NodeT *nodeArray[], int indexOfRoot, int size, Operation* o) {
 	}
 
 	// update index of the element with the largest value, if necessary
-	if (rightChild < size && nodeArray[rightChild]->value < nodeArray[largest]->value) {
+	if (rightChild < size && less(nodeArray[rightChild], nodeArray[largest])) {
 		largest = rightChild;
 	}
 	if (rightChild < size) {
@@ -195,12 +206,13 @@ void heapify(NodeT *nodeArray[], int indexOfRoot, int size, Operation* o) {
 		swap(&nodeArray[largest], &nodeArray[indexOfRoot]);
 		o->count(3);
 
-		heapify(nodeArray, largest, size, o);
+		heapify(nodeArray, largest, size, less, o);
 	}
 }
 
 // extracts the root (smallest element) from the min heap
-NodeT *extractHeap(NodeT *nodeArray[], int *heapSize, Operation *o) {
+template <typename Counter, typename Array, typename Less>
+NodeT *extractHeap(Array nodeArray, int *heapSize, Less less, Counter *o) {
 	if (*heapSize < 1) {
 		fatal_error("heap underflow!");
 	}
@@ -209,32 +221,32 @@ NodeT *extractHeap(NodeT *nodeArray[], int *heapSize, Operation *o) {
 	nodeArray[0] = nodeArray[*heapSize - 1];
 	(*heapSize)--;
 
-	heapify(nodeArray, 0, *heapSize, o);
+	heapify(nodeArray, 0, *heapSize, less, o);
 	return min;
 }
 
-// given k ascending lists, merges them in O(nlogk)
-ListT *mergeLists(int k, ListT *listArray[], int size) {
-	Operation o = profiler.createOperation("mergeOperations", size);
+// given k ascending lists, merges them in O(nlogk), with the heap in heapArray (at least k elements) ordered by less
+template <typename Counter, typename Array, typename Less>
+ListT *mergeLists(int k, ListT *listArray[], int size, Array heapArray, Less less) {
+	Counter o = profiler.createCounter<Counter>("mergeOperations", size);
 
 	// list that will hold the result
 	ListT *newList = createListHead();
 	int heapSize = 0;
-	NodeT *heapArray[MAX_NR_OF_LISTS];
 
 	// insert first elements from each and every list into the heap
 	for (int i = 0; i < k; i++) {
-		insertHeap(heapArray, &heapSize, k, listArray[i]->first, &o);
+		insertHeap(heapArray, &heapSize, k, listArray[i]->first, less, &o);
 	}
 
 	// as long as there are still elements in the heap
 	while (heapSize != 0) {
 		// extract the min element
-		NodeT *top = extractHeap(heapArray, &heapSize, &o);
+		NodeT *top = extractHeap(heapArray, &heapSize, less, &o);
 
 		// if the list that gave the element still has elements, insert the next into the heap
 		if (top->next) {
-			insertHeap(heapArray, &heapSize, k, top->next, &o);
+			insertHeap(heapArray, &heapSize, k, top->next, less, &o);
 		}
 
 		// add the extracted node to the resulting list
@@ -245,6 +257,23 @@ ListT *mergeLists(int k, ListT *listArray[], int size) {
 	return newList;
 }
 
+// mergeLists with the operations counted by hand, into mergeOperations
+template <typename Counter = DefaultOperation>
+ListT *mergeLists(int k, ListT *listArray[], int size) {
+	NodeT *heapArray[MAX_NR_OF_LISTS];
+
+	return mergeLists<Counter>(k, listArray, size, heapArray, NodeLess());
+}
+
+// mergeLists with the accesses to the heap counted by CountedArray and its comparisons by CountedCompare, into the series
+// of operations, the same way as the sorts and heaps of the other assignments
+ListT *mergeListsCounted(int k, ListT *listArray[], int size, CountedOperations<> &operations) {
+	NodeT *heapArray[MAX_NR_OF_LISTS];
+
+	return mergeLists<NullOperation>(k, listArray, size, CountedArray<NodeT*>(heapArray, operations),
+									 CountedCompare<NodeT*, DefaultOperation, NodeLess>(operations));
+}
+
 // given a random array and an empty list, copies the array into the list
 void arrayToList(int *intArray, ListT *listRef, int length) {
 	if (listRef->nrElements != 0) {
@@ -288,28 +317,35 @@ void generateListSizeArray(int k, int n, int *listSizeArray) {
 	listSizeArray[k - 1] += diff;
 }
 
-// generates k sorted lists of arbitrary length
-void populateLists(int k, ListT *listArray[], int *listSizeArray) {
+// generates k sorted lists of arbitrary length, whose values follow the given distribution
+void populateLists(int k, ListT *listArray[], int *listSizeArray, const char *distribution = "uniform") {
 	int auxArray[MAX_NR_ELEMENTS];
 
 	for (int i = 0; i < k; i++) {
 		listArray[i] = createListHead();
-		FillRandomArray(auxArray, listSizeArray[i], 0, 50000, false, 1);
+		FillDistributedArray(auxArray, listSizeArray[i], distribution, 0, 50000);
+		std::sort(auxArray, auxArray + listSizeArray[i]);
 		arrayToList(auxArray, listArray[i], listSizeArray[i]);
 	}
 }
 
-void averageCase(void) {
+// the distribution is one of the names known by FillDistributedArray
+void averageCase(const char *distribution = "uniform") {
 	ListT *listArray[MAX_NR_OF_LISTS];
 	int listSizeArray[MAX_NR_OF_LISTS];
 	const int kValue[3] = { 5, 10, 100 };
 
+	// the nodes of the merged list are allocated one by one, the report shows what that costs
+	profiler.trackAllocations();
+
 	for (int i = 0; i < 3; i++) {
 		for (int j = 100; j <= MAX_NR_ELEMENTS; j += 100) {
 			generateListSizeArray(kValue[i], j, listSizeArray);
-			populateLists(kValue[i], listArray, listSizeArray);
+			populateLists(kValue[i], listArray, listSizeArray, distribution);
 
-			ListT *sortedList = mergeLists(kValue[i], listArray, j);
+			// the accesses to the heap are counted by CountedArray, instead of the counts placed by hand
+			CountedOperations<> operations(profiler, "merge", j);
+			ListT *sortedList = mergeListsCounted(kValue[i], listArray, j, operations);
 
 			for (int i = 0; i < kValue[i]; i++) {
 				deallocateList(listArray[i]);
@@ -319,11 +355,11 @@ void averageCase(void) {
 		}
 
 		switch (i) {
-			case 0: profiler.createGroup("k=5 Average Case", "mergeOperations");
+			case 0: profiler.createGroup("k=5 Average Case", "merge_reads", "merge_writes", "merge_swaps", "merge_comparisons");
 					break;
-			case 1: profiler.createGroup("k=10 Average Case", "mergeOperations");
+			case 1: profiler.createGroup("k=10 Average Case", "merge_reads", "merge_writes", "merge_swaps", "merge_comparisons");
 					break;
-			case 2: profiler.createGroup("k=100 Average Case", "mergeOperations");
+			case 2: profiler.createGroup("k=100 Average Case", "merge_reads", "merge_writes", "merge_swaps", "merge_comparisons");
 		}
 
 		profiler.reset("First Part Average");
@@ -331,9 +367,10 @@ void averageCase(void) {
 
 	for (int i = 10; i <= 500; i += 10) {
 		generateListSizeArray(i, MAX_NR_ELEMENTS, listSizeArray);
-		populateLists(i, listArray, listSizeArray);
+		populateLists(i, listArray, listSizeArray, distribution);
 
-		ListT *sortedList = mergeLists(i, listArray, i);
+		CountedOperations<> operations(profiler, "merge", i);
+		ListT *sortedList = mergeListsCounted(i, listArray, i, operations);
 
 		for (int i = 0; i < i; i++) {
 			deallocateList(listArray[i]);
@@ -342,11 +379,13 @@ void averageCase(void) {
 		deallocateList(sortedList);
 	}
 
-	profiler.createGroup("n=10000 Average Case", "mergeOperations");
+	profiler.createGroup("n=10000 Average Case", "merge_reads", "merge_writes", "merge_swaps", "merge_comparisons");
 	
 	profiler.showReport();
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 int main(void)
 {
 	ListT *listArray[MAX_NR_OF_LISTS];
@@ -374,4 +413,5 @@ int main(void)
 	/*averageCase();*/
 
 	return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
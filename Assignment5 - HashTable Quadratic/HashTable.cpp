@@ -1,4 +1,5 @@
 #include "HashTable.h"
+#include "Profiler.h"
 #include <string.h>
 #include <iostream>
 
@@ -21,7 +22,7 @@ static bool compareEntry(EntryT *a, int id, char *name) {
 
 EntryT *newEntry(int id, char *name) {
 	if (id > 0 && name != NULL && strlen(name) > 0) {
-		EntryT *entry = (EntryT*)malloc(sizeof(EntryT));
+		EntryT *entry = (EntryT*)TrackedMalloc(sizeof(EntryT));
 		if (entry) {
 			entry->id = id;
 			strcpy(entry->name, name);
@@ -98,7 +99,11 @@ void insertHashTable(HashTableT *hashT, int id, char *name)
 			hashT->storageArray[i].data = newEntry(id, name);
 		}
 		else
+		{
+			// the probe sequence found no free slot: nothing was inserted
 			fprintf(stderr, "The hash table is full!");
+			return;
+		}
 	}
 	else {
 		hashT->storageArray[initialPos].flag = PLACED;
@@ -157,7 +162,7 @@ void deleteHashTable(HashTableT *hashT, int id, char *name)
 	if (found != NOT_FOUND)
 	{
 		hashT->storageArray[found].flag = DELETED;
-		free(hashT->storageArray[found].data);
+		TrackedFree(hashT->storageArray[found].data);
 		hashT->storageArray[found].data = NULL;
 		hashT->nrElements--;
 	}
@@ -169,7 +174,7 @@ void purgeHashTable(HashTableT *hashT)
 {
 	for (int i = 0; i < hashT->arraySize; i++)
 	{
-		free(hashT->storageArray[i].data);
+		TrackedFree(hashT->storageArray[i].data);
 		hashT->storageArray[i].data = NULL;
 	}
 
@@ -50,7 +50,7 @@ int *buildArray(int n) {
 }
 
 TreeNode *allocNode(int key) {
-	TreeNode *newNode = (TreeNode*)malloc(sizeof(TreeNode));
+	TreeNode *newNode = (TreeNode*)TrackedMalloc(sizeof(TreeNode));
 
 	if (newNode) {
 		newNode->key = key;
@@ -63,7 +63,8 @@ TreeNode *allocNode(int key) {
 	return newNode;
 }
 
-TreeNode *buildBalancedTree(int *array, int left, int right, Operation *o) {
+template <typename Counter>
+TreeNode *buildBalancedTree(int *array, int left, int right, Counter *o) {
 	if (left > right) {
 		return NULL;
 	}
@@ -84,14 +85,16 @@ TreeNode *buildBalancedTree(int *array, int left, int right, Operation *o) {
 	return tree;
 }
 
-TreeNode *selectNode(TreeNode *pTree, int pos, Operation *o) {
+// the node is a TreeNode * or a SimulatedPointer<TreeNode>, to count the cache misses of walking down the tree
+template <typename Counter, typename Node>
+Node selectNode(Node pTree, int pos, Counter *o) {
 	if (!pTree) {
 		return NULL;
 	}
 	
 	int nrLeft = 1;
 	if (pTree->left) {
-		nrLeft = pTree->left->dimension + 1;
+		nrLeft = Node(pTree->left)->dimension + 1;
 		o->count();
 	}
 
@@ -101,14 +104,15 @@ TreeNode *selectNode(TreeNode *pTree, int pos, Operation *o) {
 		return pTree;
 	}
 	else if (pos < nrLeft) {
-		return selectNode(pTree->left, pos, o);
+		return selectNode(Node(pTree->left), pos, o);
 	}
 	else {
-		return selectNode(pTree->right, pos - nrLeft, o);
+		return selectNode(Node(pTree->right), pos - nrLeft, o);
 	}
 }
 
-TreeNode *findMax(TreeNode *pTree, Operation *o)
+template <typename Counter>
+TreeNode *findMax(TreeNode *pTree, Counter *o)
 {
 	if (!pTree)
 		return NULL;
@@ -121,7 +125,8 @@ TreeNode *findMax(TreeNode *pTree, Operation *o)
 		return pTree;
 }
 
-TreeNode *deleteNode(TreeNode *pTree, TreeNode *nodeToDelete, Operation *o)
+template <typename Counter>
+TreeNode *deleteNode(TreeNode *pTree, TreeNode *nodeToDelete, Counter *o)
 {
 	if (!pTree) {
 		return NULL;
@@ -157,7 +162,7 @@ TreeNode *deleteNode(TreeNode *pTree, TreeNode *nodeToDelete, Operation *o)
 				pTree = NULL;
 			}
 
-			free(toDel);
+			TrackedFree(toDel);
 			o->count();
 		}
 	}
@@ -184,16 +189,21 @@ void purgeTree(TreeNode **pTree)
 	{
 		purgeTree(&((*pTree)->left));
 		purgeTree(&((*pTree)->right));
-		free(*pTree);
+		TrackedFree(*pTree);
 		*pTree = NULL;
 	}
 }
 
 void averageCase() {
-	for (int i = 100; i < MAX_NR_NODES; i += INCREMENT) {
-		Operation o = profiler.createOperation("Avg Case Analysis", i);
+	BenchmarkRunner runner(profiler);
+
+	// the nodes of the tree are allocated one by one, the report shows what that costs
+	profiler.trackAllocations();
 
-		for (int samples = 0; samples < 4; samples++) {
+	for (int i = 100; i < MAX_NR_NODES; i += INCREMENT) {
+		// every sample counts into its own counter, the runner keeps the mean of the samples
+		runner.run("Avg Case Analysis", i, [i]() {
+			DefaultOperation o = profiler.createCounter<DefaultOperation>("Avg Case Analysis", i);
 			int *inputArray = buildArray(i), itemsLeft = i;
 			TreeNode *tree = buildBalancedTree(inputArray, 0, i - 1, &o);
 
@@ -204,20 +214,22 @@ void averageCase() {
 			}
 
 			purgeTree(&tree);
-		}
+			free(inputArray);
+		});
 	}
 
-	profiler.divideValues("Avg Case Analysis", 5);
 	profiler.createGroup("Average Case Analysis", "Avg Case Analysis");
 
 	profiler.showReport();
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 int main()
 {
 	/* int arraySize = 11, *array = buildArray(arraySize);
 	int randomKeys[3];
-	Operation o = profiler.createOperation("demo", arraySize);
+	DefaultOperation o = profiler.createCounter<DefaultOperation>("demo", arraySize);
 	
 	TreeNode *tree = buildBalancedTree(array, 0, arraySize - 1, &o);
 	printTree(tree, 0);
@@ -239,4 +251,4 @@ int main()
 
 	averageCase();
 }
-
+#endif
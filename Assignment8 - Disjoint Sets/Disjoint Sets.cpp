@@ -46,9 +46,10 @@ void fatalError(const char *msg)
     exit(EXIT_FAILURE);
 }
 
-NodeT *makeSet(int key, Operation *o)
+template <typename Counter>
+NodeT *makeSet(int key, Counter *o)
 {
-    NodeT *newNode = (NodeT *)malloc(sizeof(NodeT));
+    NodeT *newNode = (NodeT *)TrackedMalloc(sizeof(NodeT));
 
     if (newNode)
     {
@@ -64,7 +65,8 @@ NodeT *makeSet(int key, Operation *o)
     return newNode;
 }
 
-NodeT *findSet(NodeT *setElement, Operation *o)
+template <typename Counter>
+NodeT *findSet(NodeT *setElement, Counter *o)
 {
     // uses path compression
     if (setElement->parent != setElement)
@@ -76,7 +78,8 @@ NodeT *findSet(NodeT *setElement, Operation *o)
     return setElement->parent;
 }
 
-void unionSet(NodeT *firstSet, NodeT *secondSet, Operation *o)
+template <typename Counter>
+void unionSet(NodeT *firstSet, NodeT *secondSet, Counter *o)
 {
     if (firstSet == secondSet)
     {
@@ -113,7 +116,8 @@ void unionSet(NodeT *firstSet, NodeT *secondSet, Operation *o)
     }
 }
 
-void buildAllSets(int upperBound, NodeT **setsArray, Operation *o)
+template <typename Counter>
+void buildAllSets(int upperBound, NodeT **setsArray, Counter *o)
 {
     for (int i = 0; i < upperBound; i++)
     {
@@ -134,7 +138,7 @@ GraphT *newGraph(int nrVertices, int nrEdges)
 
 EdgeT *createNewEdge(int source, int destination, int weight)
 {
-    EdgeT *newEdge = (EdgeT *)malloc(sizeof(EdgeT));
+    EdgeT *newEdge = (EdgeT *)TrackedMalloc(sizeof(EdgeT));
 
     newEdge->source = source;
     newEdge->destination = destination;
@@ -175,11 +179,18 @@ int compare(const void *a, const void *b) {
 }
 
 // given a graph, returns MST
-GraphT *kruskal(GraphT *graph, NodeT **setsArray, Operation *o) {
+template <typename Counter>
+GraphT *kruskal(GraphT *graph, NodeT **setsArray, Counter *o) {
     GraphT *MST = newGraph(graph->nrVertices, graph->nrVertices - 1);
     int indexGraph = 0, indexMST = 0;
+    Scope kruskalScope(profiler, "kruskal", graph->nrVertices, o);
 
-    sort(graph->edges, graph->edges + graph->nrEdges, compare);
+    {
+        Scope phase(profiler, "sort", graph->nrEdges, o);
+        sort(graph->edges, graph->edges + graph->nrEdges, compare);
+    }
+    // a scope per call would cost more than the calls themselves, the loop is measured as a whole
+    Scope phase(profiler, "findSet and unionSet", graph->nrVertices, o);
     while(indexMST < MST->nrEdges) {
         EdgeT *currentEdge = graph->edges[indexGraph++];
 
@@ -194,15 +205,16 @@ GraphT *kruskal(GraphT *graph, NodeT **setsArray, Operation *o) {
 
 void freeSets(NodeT **setsArray, int size) {
     for (int i = 0; i < size; i++) {
-        free(setsArray[i]);
+        TrackedFree(setsArray[i]);
     }
 }
 
 void freeGraph(GraphT *graph) {
     for (int i = 0; i < graph->nrEdges; i++) {
-        free(graph->edges[i]);
+        TrackedFree(graph->edges[i]);
     }
 
+    free(graph->edges);
     free(graph);
 }
 
@@ -210,9 +222,11 @@ void averageCase()
 {
     NodeT *setsArray[MAX_NR_NODES];
 
+    // the sets and the edges are allocated one by one, the report shows what that costs
+    profiler.trackAllocations();
     for (int n = 100; n < MAX_NR_NODES; n += 100)
     {
-        Operation o = profiler.createOperation("Average Case", n);
+        DefaultOperation o = profiler.createCounter<DefaultOperation>("Average Case", n);
 
         buildAllSets(n, setsArray, &o);
         GraphT *graph = createGraph(n, 4 * n);
@@ -221,6 +235,7 @@ void averageCase()
         freeSets(setsArray, n);
         freeGraph(graph);
         // edges already deallocated
+        free(MST->edges);
         free(MST);
         MST = NULL;
     }
@@ -235,13 +250,15 @@ void printAllEdges(GraphT *graph) {
     }
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 int main(int argc, char const *argv[])
 {
     srand(time(NULL));
 
     /* int nrSets = 10;
     NodeT *setsArray[nrSets];
-    Operation o = profiler.createOperation("Test Drive", nrSets);
+    DefaultOperation o = profiler.createCounter<DefaultOperation>("Test Drive", nrSets);
 
     buildAllSets(nrSets, setsArray, &o);
     for (int i = 1; i <= 5; i++) {
@@ -274,3 +291,4 @@ int main(int argc, char const *argv[])
 
     return 0;
 }
+#endif
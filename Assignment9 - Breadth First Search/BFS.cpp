@@ -127,7 +127,8 @@ GraphT *generateRandomGraph(int nrVertices, int nrEdges)
     return newGraph;
 }
 
-void BFS(GraphT *graph, int sourceNode, Operation *o)
+template <typename Counter>
+void BFS(GraphT *graph, int sourceNode, Counter *o)
 {
     graph->nodeLists[sourceNode]->color = GREY;
     graph->nodeLists[sourceNode]->dist = 0;
@@ -166,7 +167,8 @@ void BFS(GraphT *graph, int sourceNode, Operation *o)
 }
 
 // in case the graph is not connected
-void unconnectedBFS(GraphT *graph, Operation *o)
+template <typename Counter>
+void unconnectedBFS(GraphT *graph, Counter *o)
 {
     initializeGraph(graph);
 
@@ -199,13 +201,14 @@ void prettyPrint(GraphT *graph)
     }
 }
 
+// the graph is allocated with new, so that the adjacency lists are constructed (and destroyed here)
 void freeGraph(GraphT *graph) {
     for (int i = 0; i < graph->nrVertices; i++) {
-        free(graph->nodeLists[i]);
+        delete graph->nodeLists[i];
     }
 
-    free(graph->nodeLists);
-    free(graph);
+    delete[] graph->nodeLists;
+    delete graph;
 }
 
 void averageCase()
@@ -213,7 +216,7 @@ void averageCase()
     for (int nrEdges = 1000; nrEdges <= 5000; nrEdges += 100)
     {
         const int nrVertices = 100;
-        Operation o = profiler.createOperation("nrOpsFixedVertices", nrEdges);
+        DefaultOperation o = profiler.createCounter<DefaultOperation>("nrOpsFixedVertices", nrEdges);
 
         GraphT *graph = generateRandomGraph(nrVertices, nrEdges);
         unconnectedBFS(graph, &o);
@@ -226,7 +229,7 @@ void averageCase()
     for (int nrVertices = 100; nrVertices <= 200; nrVertices += 10)
     {
         const int nrEdges = 4500;
-        Operation o = profiler.createOperation("nrOpsFixedEdges", nrVertices);
+        DefaultOperation o = profiler.createCounter<DefaultOperation>("nrOpsFixedEdges", nrVertices);
 
         GraphT *graph = generateRandomGraph(nrVertices, nrEdges);
         unconnectedBFS(graph, &o);
@@ -237,12 +240,14 @@ void averageCase()
     profiler.showReport();
 }
 
+// the benchmark driver compiles this file as one of its modules, with a main of its own
+#ifndef BENCHMARK_DRIVER
 main(int argc, char const *argv[])
 {
     srand(time(NULL));
 
     const int nrVertices = 10, nrEdges = 25;
-    Operation o = profiler.createOperation("demo", nrVertices + nrEdges);
+    DefaultOperation o = profiler.createCounter<DefaultOperation>("demo", nrVertices + nrEdges);
 
     GraphT *newGraph = generateRandomGraph(nrVertices, nrEdges);
     unconnectedBFS(newGraph, &o);
@@ -253,3 +258,4 @@ main(int argc, char const *argv[])
 
     return 0;
 }
+#endif
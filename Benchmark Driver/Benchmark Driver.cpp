@@ -0,0 +1,1416 @@
+/**
+ * Benchmark driver
+ *
+ * Runs the workload of any algorithm of the assignments over a range of sizes, without recompiling and
+ * without the fixed size stack arrays of the assignments. Every assignment is compiled in its own namespace
+ * and keeps its own profiler, the driver only generates the inputs (on the heap) and sweeps the sizes.
+ *
+ * usage: "Benchmark Driver" --algorithm NAME [options], or --list to see the algorithms and distributions
+ *
+ *	--min N, --max N, --step N	the sizes of the sweep (100, 10000, 100)
+ *	--factor F			multiplies the size by F at every step instead of adding the step
+ *	--distribution NAME		the distribution of the inputs (uniform)
+ *	--reps N, --min-reps N		the maximum and minimum number of samples of a point (100, 5)
+ *	--confidence C, --error E	the confidence interval a point must reach (0.95, 0.02)
+ *	--threads N			the threads used to generate the inputs and by the parallel sorts, 0 for all of them (0)
+ *	--seed S			the seed of the generated inputs
+ *	--format F, --output FILE	html, csv, jsonl or binary (html). the html report is named by the profiler
+ *	--k K, --vertices V, --fill F	the lists of k-way-merge (10), the vertices of bfs and dfs (100),
+ *					the filling factor of hash-table (0.95)
+ *	--save-baseline FILE		saves the complexity fits of the operation counts of the run
+ *	--baseline FILE, --tolerance T	compares the run against a baseline, the exit code is 2 if it regressed
+ *	--track-allocations		adds the allocations made by the algorithm to the report
+ *	--simulate-cache		adds the misses of a simulated L1/L2/L3 hierarchy to the report (heap-sort and
+ *					the selections of order-statistics go through the simulated cache)
+ *	--cache SIZE:WAYS:LINE,...	the same, with the given levels (capacity and line size in bytes)
+ *	--count-accesses		the sorts and heaps of assignments 1 to 4 count the reads, writes, swaps and
+ *					comparisons of their arrays with CountedArray, instead of the counts placed by hand
+ *	--hardware-counters		adds the cycles, instructions, cache misses and branch mispredictions of the
+ *					timed samples to the report (linux perf events)
+ *	--partition SCHEME		the partition of quick-sort and quick-sort-randomized: lomuto (the default),
+ *					block (the branchless partition of BlockQuicksort), three-way (dutch national
+ *					flag) or dual-pivot (Yaroslavskiy)
+ *	--trace FILE			writes the scopes of the run (heap-sort and kruskal have some) as a chrome trace
+ *	--folded FILE, --folded-operations FILE
+ *					writes the call tree of the scopes as folded stacks of nanoseconds or operations
+ *	--pin CORE			pins the benchmark to a core
+ *	--warmup N			untimed iterations before the samples of every size (0)
+ *	--caches cold|warm		flushes the caches before every sample, and for warm brings the input of the sorts
+ *					back into them (the hash table stays as it was built). run the same sweep with both
+ *					to compare cold and warm numbers
+ *	--huge-pages			allocates the input arrays on huge pages
+ *	the governor and the frequency of the cpu are recorded in the environment of the report
+ *	--keys int|int64|double|record	the elements of the sorts of the library (int): 64 bit integers, doubles
+ *					or 64 byte records sorted by a 64 bit key
+ *	--digit-bits B			the width of the digits of the radix sorts, 1 to 16 (8)
+ *	--save-workload FILE		saves the first input of every size to a workload file (see WorkloadWriter)
+ *	--workload FILE			replays the inputs of a workload file instead of generating them, for every sample.
+ *					the sweep and the algorithm must be one the file was saved with: the arrays serve
+ *					every sort and heap, the keys the hash table, the lists k-way-merge (with the same k),
+ *					the graphs kruskal, and bfs and dfs (with the same number of vertices)
+ */
+
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <queue>
+#include <stack>
+#include <ctime>
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "Profiler.h"
+#include "../Sorting Library/Sorting.h"
+#include "../Sorting Library/ParallelSort.h"
+#include "../Sorting Library/RadixSort.h"
+
+#define BENCHMARK_DRIVER
+
+// the assignments define the same names, so each one gets a namespace
+namespace directSorting {
+#include "../Assignment1 - Direct Sorting Methods/Direct Sorting.cpp"
+}
+namespace buildHeap {
+#include "../Assignment2 - buildHeap and heapSort/buildHeap and heapSort.cpp"
+}
+namespace advancedSorting {
+#include "../Assignment3 - heapSort and quickSort/heapSort and quickSort.cpp"
+}
+namespace kWayMerge {
+#include "../Assignment4 - k-way Merge/k-way Merge.cpp"
+}
+namespace hashTable {
+#include "../Assignment5 - HashTable Quadratic/HashTable.cpp"
+#include "../Assignment5 - HashTable Quadratic/HashTable Quadratic.cpp"
+// assignment 5 writes its results to a text file, the searches of the driver are counted here
+Profiler profiler("Hash Table Search");
+}
+namespace orderStatistics {
+#include "../Assignment6 - Order Statistics/Order Statistics.cpp"
+}
+namespace disjointSets {
+#include "../Assignment8 - Disjoint Sets/Disjoint Sets.cpp"
+}
+namespace breadthFirstSearch {
+#include "../Assignment9 - Breadth First Search/BFS.cpp"
+}
+namespace depthFirstSearch {
+#include "../Assignment10 - DFS, TARJAN, TOPSORT/DFS TARJAN TOPSORT.cpp"
+}
+
+// the workloads that do not come from an assignment
+Profiler driverProfiler("Benchmark Driver");
+
+struct Options {
+	const char *algorithm, *format, *output, *baseline, *saveBaseline, *keys;
+	// NULL if not written
+	const char *trace, *foldedTimes, *foldedOperations;
+	bool trackAllocations, countAccesses, hugePages, hardwareCounters;
+	advancedSorting::PartitionScheme partition;
+	BenchmarkIsolation *isolation;
+	// NULL if the inputs are generated, or not saved
+	const char *savedWorkload, *replayedWorkload;
+	WorkloadSnapshot *snapshot;
+	WorkloadWriter *snapshotWriter;
+	// no levels if the cache is not simulated
+	CacheSimulator cache;
+	int distribution, minSize, maxSize, step, minSamples, maxSamples, threads, k, vertices, digitBits;
+	double factor, confidence, relativeError, tolerance, fillFactor;
+};
+
+/**
+* one algorithm that the driver can run: its name, the profiler of its assignment and the sweep itself
+*/
+struct Workload {
+	const char *name;
+	const char *description;
+	Profiler *profiler;
+	void (*run)(const Options &options);
+};
+
+/**
+* calls step(size) for every size of the sweep
+*/
+template <typename Step>
+void sweep(const Options &options, Step step) {
+	long long size = options.minSize;
+
+	while (size <= options.maxSize) {
+		step((int)size);
+		size = options.factor > 1 ? std::max(size + 1, (long long)(size * options.factor)) : size + options.step;
+	}
+}
+
+BenchmarkRunner createRunner(Profiler &profiler, const Options &options) {
+	BenchmarkRunner runner(profiler, options.confidence, options.relativeError, options.minSamples, options.maxSamples);
+	runner.isolate(*options.isolation);
+	return runner;
+}
+
+/**
+* the input array of a workload, of the largest size of the sweep, on huge pages if the options ask for it
+*/
+template <typename T>
+class InputBuffer {
+public:
+	InputBuffer(const Options &options) : hugePages(options.hugePages) {
+		size_t bytes = (options.maxSize > 0 ? options.maxSize : 1) * sizeof(T);
+		data = (T*)(hugePages ? BenchmarkIsolation::allocateHugePages(bytes) : malloc(bytes));
+		if (!data) {
+			throw "out of memory";
+		}
+	}
+
+	~InputBuffer() {
+		if (hugePages) {
+			BenchmarkIsolation::freeHugePages(data);
+		}
+		else {
+			free(data);
+		}
+	}
+
+	T &operator[](int i) {
+		return data[i];
+	}
+
+private:
+	T *data;
+	bool hugePages;
+
+	InputBuffer(const InputBuffer&);
+	InputBuffer& operator=(const InputBuffer&);
+};
+
+/**
+* the first size elements of the input are what a warm cache holds before a sample
+*/
+template <typename T>
+void warmInput(const Options &options, const T *values, int size) {
+	options.isolation->clearRegions();
+	options.isolation->warmRegion(values, size * sizeof(T));
+}
+
+/**
+* fills the array with the distribution of the options. the large uniform arrays are generated in parallel
+*/
+void fillArray(int *intArray, int size, const Options &options) {
+	if (options.distribution == UNIFORM && options.threads != 1) {
+		FillRandomArrayParallel(intArray, size, 10, 50000, DefaultRandomGenerator().next(), options.threads);
+	}
+	else {
+		FillDistributedArray(intArray, size, options.distribution, 10, 50000, DefaultRandomGenerator());
+	}
+}
+
+/**
+* the name of the input of a size in a workload file
+*/
+std::string inputName(const char *kind, int size) {
+	char name[64];
+	snprintf(name, sizeof(name), "%s %d", kind, size);
+	return name;
+}
+
+/**
+* prepares the input array of a sample: replays it from the workload file, or generates it with fill() and
+* saves it if it is the first one of its size
+*/
+template <typename Fill>
+void prepareArray(const Options &options, const char *kind, int *intArray, int size, Fill fill) {
+	std::string name = inputName(kind, size);
+
+	if (options.snapshot) {
+		size_t count;
+		const int *values = options.snapshot->array(name.c_str(), count);
+		if (count != (size_t)size) {
+			throw "the workload file does not match the sweep";
+		}
+		memcpy(intArray, values, size * sizeof(int));
+		return;
+	}
+	fill();
+	if (options.snapshotWriter && !options.snapshotWriter->contains(name.c_str())) {
+		options.snapshotWriter->writeArray(name.c_str(), intArray, size);
+	}
+}
+
+void prepareArray(const Options &options, int *intArray, int size) {
+	prepareArray(options, "array", intArray, size, [&]() { fillArray(intArray, size, options); });
+}
+
+/**
+* the counting policy of the counts placed by hand in the algorithms. they are left out when the array counts
+* its own accesses, so that every algorithm is measured the same way
+*/
+template <typename Array>
+struct HandCounter {
+	typedef DefaultOperation type;
+};
+
+template <typename T, typename Counter>
+struct HandCounter<CountedArray<T, Counter> > {
+	typedef NullOperation type;
+};
+
+/**
+* fails the workload when a sample left the output of name out of order. the check runs after the timer is
+* stopped, a sort that is fast because it is wrong must not make it to the results
+*/
+void checkOrder(const char *name, bool ordered) {
+	if (!ordered) {
+		fprintf(stderr, "error: %s left its output out of order\n", name);
+		throw "the output of a sample is out of order";
+	}
+}
+
+bool isSorted(const int *first, const int *last) {
+	return std::is_sorted(first, last);
+}
+
+// the heaps of buildHeap are max-heaps
+bool isHeap(const int *first, const int *last) {
+	return std::is_heap(first, last);
+}
+
+/**
+* the workload of the algorithms that take an array and its size: a new input for every sample, only the sort is timed.
+* sort(array, size) is called with an int *, or with a CountedArray<int> if the accesses are counted.
+* every sample must leave the array ordered as isOrdered expects, sorted unless told otherwise
+*/
+template <typename Sort>
+void arrayWorkload(const Options &options, Profiler &profiler, const char *name, Sort sort,
+				   std::vector<const char*> alsoSampled = std::vector<const char*>(),
+				   bool (*isOrdered)(const int*, const int*) = isSorted) {
+	InputBuffer<int> intArray(options);
+	std::vector<std::string> countedSeries = CountedOperations<>::seriesNames(name);
+	BenchmarkRunner runner = createRunner(profiler, options);
+
+	if (options.countAccesses) {
+		for (int i = 0; i < 4; i++) {
+			alsoSampled.push_back(countedSeries[i].c_str());
+		}
+	}
+	sweep(options, [&](int size) {
+		warmInput(options, &intArray[0], size);
+		runner.runChecked(name, size, [&]() { prepareArray(options, &intArray[0], size); }, [&]() {
+			if (options.countAccesses) {
+				CountedOperations<> operations(profiler, name, size);
+				sort(CountedArray<int>(&intArray[0], operations), size);
+			}
+			else {
+				sort(&intArray[0], size);
+			}
+		}, [&]() { checkOrder(name, isOrdered(&intArray[0], &intArray[0] + size)); }, alsoSampled);
+	});
+}
+
+void runSelectionSort(const Options &options) {
+	arrayWorkload(options, directSorting::profiler, "selectionSort", [](auto intArray, int size) {
+		directSorting::selectionSort<typename HandCounter<decltype(intArray)>::type>(intArray, size);
+	}, { "selectionSortAss", "selectionSortComp" });
+}
+
+void runBubbleSort(const Options &options) {
+	arrayWorkload(options, directSorting::profiler, "bubbleSort", [](auto intArray, int size) {
+		directSorting::bubbleSort<typename HandCounter<decltype(intArray)>::type>(intArray, size);
+	}, { "bubbleSortAss", "bubbleSortComp" });
+}
+
+void runInsertionSort(const Options &options) {
+	arrayWorkload(options, directSorting::profiler, "insertionSort", [](auto intArray, int size) {
+		directSorting::insertionSort<typename HandCounter<decltype(intArray)>::type>(intArray, size);
+	}, { "insertionSortAss", "insertionSortComp" });
+}
+
+void runBuildHeapTopDown(const Options &options) {
+	arrayWorkload(options, buildHeap::profiler, "operationsTopDown", [](auto intArray, int size) {
+		buildHeap::buildHeapTopDown<typename HandCounter<decltype(intArray)>::type>(intArray, size);
+	}, {}, isHeap);
+}
+
+void runBuildHeapBottomUp(const Options &options) {
+	arrayWorkload(options, buildHeap::profiler, "operationsBottomUp", [](auto intArray, int size) {
+		buildHeap::buildHeapBottomUp<typename HandCounter<decltype(intArray)>::type>(intArray, size);
+	}, {}, isHeap);
+}
+
+// heap-sort goes through the simulated cache when it is enabled
+void heapSortOn(int *intArray, int size, const Options &options) {
+	if (options.cache.levelCount() > 0) {
+		advancedSorting::heapSort(SimulatedArray<int>(intArray), size);
+	}
+	else {
+		advancedSorting::heapSort(intArray, size);
+	}
+}
+
+void heapSortOn(CountedArray<int> intArray, int size, const Options &) {
+	advancedSorting::heapSort<NullOperation>(intArray, size);
+}
+
+void runHeapSort(const Options &options) {
+	arrayWorkload(options, advancedSorting::profiler, "operationsHeapSort", [&options](auto intArray, int size) {
+		heapSortOn(intArray, size, options);
+	});
+}
+
+void runQuickSort(const Options &options) {
+	arrayWorkload(options, advancedSorting::profiler, "operationsQuickSort", [&options](auto intArray, int size) {
+		typedef typename HandCounter<decltype(intArray)>::type Counter;
+		Counter o = advancedSorting::profiler.createCounter<Counter>("operationsQuickSort", size);
+		advancedSorting::quickSort(intArray, 0, size - 1, &o, options.partition);
+	});
+}
+
+void runQuickSortRandomized(const Options &options) {
+	arrayWorkload(options, advancedSorting::profiler, "operationsQuickSortRandomized", [&options](auto intArray, int size) {
+		typedef typename HandCounter<decltype(intArray)>::type Counter;
+		Counter o = advancedSorting::profiler.createCounter<Counter>("operationsQuickSortRandomized", size);
+		advancedSorting::quickSortRandomized(intArray, 0, size - 1, &o, options.partition);
+	});
+}
+
+void runQuickSortAdaptive(const Options &options) {
+	arrayWorkload(options, advancedSorting::profiler, "operationsQuickSortAdaptive", [](auto intArray, int size) {
+		typedef typename HandCounter<decltype(intArray)>::type Counter;
+		Counter o = advancedSorting::profiler.createCounter<Counter>("operationsQuickSortAdaptive", size);
+		advancedSorting::quickSortAdaptive(intArray, 0, size - 1, &o);
+	});
+}
+
+/**
+* quickSortRandomized with the partition of assignment 3 and with the block partition, on the same inputs, with
+* the hardware counters: the branch mispredictions of the two are next to each other in the report
+*/
+void runPartitionComparison(const Options &options) {
+	static const char *names[] = { "quickSortRandomized lomuto", "quickSortRandomized block" };
+	static const advancedSorting::PartitionScheme schemes[] = { advancedSorting::LOMUTO_PARTITION, advancedSorting::BLOCK_PARTITION };
+
+	if (!advancedSorting::profiler.enableHardwareCounters()) {
+		fprintf(stderr, "warning: the hardware counters are not available, only the times and the operations are compared\n");
+	}
+	for (int i = 0; i < 2; i++) {
+		advancedSorting::PartitionScheme scheme = schemes[i];
+		arrayWorkload(options, advancedSorting::profiler, names[i], [i, scheme](auto intArray, int size) {
+			typedef typename HandCounter<decltype(intArray)>::type Counter;
+			Counter o = advancedSorting::profiler.createCounter<Counter>(names[i], size);
+			advancedSorting::quickSortRandomized(intArray, 0, size - 1, &o, scheme);
+		});
+	}
+	advancedSorting::profiler.createGroup("Partition schemes", names[0], names[1]);
+}
+
+/**
+* quickSort, quickSortRandomized and quickSortAdaptive on the inputs that are already ordered in part, in one group per
+* distribution. quickSort is quadratic on the sorted and the reversed arrays, quickSortAdaptive is linear on them
+*/
+void runAdaptiveComparison(const Options &options) {
+	static const char *sorts[] = { "quickSort", "quickSortRandomized", "quickSortAdaptive" };
+	static const int distributions[] = { SORTED, REVERSED, SAWTOOTH, NEARLY_SORTED, ORGAN_PIPE, UNIFORM };
+
+	for (int distribution : distributions) {
+		Options distributed = options;
+		std::string series[3];
+
+		distributed.distribution = distribution;
+		for (int i = 0; i < 3; i++) {
+			series[i] = std::string(sorts[i]) + " " + DistributionName(distribution);
+			const char *name = series[i].c_str();
+			arrayWorkload(distributed, advancedSorting::profiler, name, [i, name](auto intArray, int size) {
+				typedef typename HandCounter<decltype(intArray)>::type Counter;
+				Counter o = advancedSorting::profiler.createCounter<Counter>(name, size);
+				if (i == 0) {
+					advancedSorting::quickSort(intArray, 0, size - 1, &o);
+				}
+				else if (i == 1) {
+					advancedSorting::quickSortRandomized(intArray, 0, size - 1, &o);
+				}
+				else {
+					advancedSorting::quickSortAdaptive(intArray, 0, size - 1, &o);
+				}
+			});
+		}
+		advancedSorting::profiler.createGroup(DistributionName(distribution), series[0].c_str(), series[1].c_str(),
+											  series[2].c_str());
+	}
+}
+
+/**
+* quickSortRandomized with every partition scheme on the inputs with few distinct keys, in one group per distribution:
+* 8 keys (few-unique), about sqrt(n) keys (many-duplicates) and zipfian keys, where a few keys are most of the array.
+* the lomuto and the block partitions are quadratic on the first two, --max must stay small enough for them
+*/
+void runDuplicateKeysComparison(const Options &options) {
+	static const char *schemes[] = { "lomuto", "block", "three-way", "dual-pivot" };
+	static const int distributions[] = { FEW_UNIQUE, MANY_DUPLICATES, ZIPF };
+
+	for (int distribution : distributions) {
+		Options distributed = options;
+		std::string series[4];
+
+		distributed.distribution = distribution;
+		for (int i = 0; i < 4; i++) {
+			series[i] = std::string("quickSortRandomized ") + schemes[i] + " " + DistributionName(distribution);
+			const char *name = series[i].c_str();
+			arrayWorkload(distributed, advancedSorting::profiler, name, [i, name](auto intArray, int size) {
+				typedef typename HandCounter<decltype(intArray)>::type Counter;
+				Counter o = advancedSorting::profiler.createCounter<Counter>(name, size);
+				advancedSorting::quickSortRandomized(intArray, 0, size - 1, &o, (advancedSorting::PartitionScheme)i);
+			});
+		}
+		advancedSorting::profiler.createGroup(DistributionName(distribution), series[0].c_str(), series[1].c_str(),
+											  series[2].c_str(), series[3].c_str());
+	}
+}
+
+/**
+* std::sort, as a reference for the sorts of the assignments. only its comparisons are counted, with CountedCompare
+*/
+void runStdSort(const Options &options) {
+	InputBuffer<int> intArray(options);
+	BenchmarkRunner runner = createRunner(driverProfiler, options);
+
+	sweep(options, [&](int size) {
+		warmInput(options, &intArray[0], size);
+		runner.runChecked("std::sort", size, [&]() { prepareArray(options, &intArray[0], size); }, [&]() {
+			CountedOperations<> operations(driverProfiler, "std::sort", size);
+			std::sort(&intArray[0], &intArray[0] + size, CountedCompare<int>(operations));
+		}, [&]() { checkOrder("std::sort", isSorted(&intArray[0], &intArray[0] + size)); }, { "std::sort_comparisons" });
+	});
+}
+
+/**
+* fills the k lists with size elements in total, replayed from the workload file or generated and saved
+*/
+void prepareLists(const Options &options, int *intArray, int size, kWayMerge::ListT **listArray) {
+	std::string name = inputName("lists", size);
+	std::vector<int> lengths(options.k);
+
+	if (options.snapshot) {
+		WorkloadSnapshot::SortedLists lists = options.snapshot->sortedLists(name.c_str());
+		if (lists.k != options.k || lists.bounds[lists.k] != (unsigned long long)size) {
+			throw "the workload file does not match the sweep";
+		}
+		memcpy(intArray, lists.values, size * sizeof(int));
+		for (int i = 0; i < options.k; i++) {
+			lengths[i] = (int)(lists.bounds[i + 1] - lists.bounds[i]);
+		}
+	}
+	else {
+		fillArray(intArray, size, options);
+		for (int i = 0, start = 0; i < options.k; i++) {
+			lengths[i] = size / options.k + (i < size % options.k ? 1 : 0);
+			std::sort(intArray + start, intArray + start + lengths[i]);
+			start += lengths[i];
+		}
+		if (options.snapshotWriter && !options.snapshotWriter->contains(name.c_str())) {
+			options.snapshotWriter->writeSortedLists(name.c_str(), intArray, &lengths[0], options.k);
+		}
+	}
+	for (int i = 0, start = 0; i < options.k; i++) {
+		kWayMerge::arrayToList(intArray + start, listArray[i], lengths[i]);
+		start += lengths[i];
+	}
+}
+
+/**
+* the elements of --keys record: a key and a payload that is moved along with it
+*/
+struct Record {
+	long long key;
+	char payload[56];
+};
+
+/**
+* the key compared by the sorts of the library, and the projection that gives it
+*/
+template <typename T>
+struct KeyTraits {
+	typedef T Key;
+	typedef sorting::Identity Projection;
+	static Projection projection() { return Projection(); }
+};
+
+template <>
+struct KeyTraits<Record> {
+	typedef long long Key;
+	typedef long long Record::*Projection;
+	static Projection projection() { return &Record::key; }
+};
+
+// the int keys are the arrays of the assignments, and can be replayed from a workload file
+void fillKeys(int *keys, int size, const Options &options) {
+	prepareArray(options, keys, size);
+}
+
+void fillKeys(long long *keys, int size, const Options &options) {
+	FillDistributedArray<long long>(keys, size, options.distribution, 0, 1LL << 48, DefaultRandomGenerator());
+}
+
+void fillKeys(double *keys, int size, const Options &options) {
+	FillDistributedArray<double>(keys, size, options.distribution, 0, 1, DefaultRandomGenerator());
+}
+
+void fillKeys(Record *records, int size, const Options &options) {
+	std::vector<long long> keys(size);
+	fillKeys(&keys[0], size, options);
+	for (int i = 0; i < size; i++) {
+		records[i].key = keys[i];
+	}
+}
+
+/**
+* checks that the sort of a sample left the elements of --keys sorted on their keys
+*/
+template <typename T>
+void checkKeysOrder(const char *name, T *values, int size) {
+	typedef KeyTraits<T> Traits;
+	checkOrder(name, std::is_sorted(values, values + size,
+		sorting::detail::ProjectedCompare<std::less<typename Traits::Key>, typename Traits::Projection>(
+			std::less<typename Traits::Key>(), Traits::projection())));
+}
+
+template <typename T, typename Sort>
+void keyedWorkload(const Options &options, const char *name, Sort sort) {
+	typedef KeyTraits<T> Traits;
+	InputBuffer<T> values(options);
+	std::string series = std::string(name) + "<" + options.keys + ">", comparisons = series + "_comparisons";
+	std::vector<const char*> alsoSampled;
+	BenchmarkRunner runner = createRunner(driverProfiler, options);
+
+	if (options.countAccesses) {
+		alsoSampled.push_back(comparisons.c_str());
+	}
+	sweep(options, [&](int size) {
+		warmInput(options, &values[0], size);
+		runner.runChecked(series.c_str(), size, [&]() { fillKeys(&values[0], size, options); }, [&]() {
+			if (options.countAccesses) {
+				CountedOperations<> operations(driverProfiler, series.c_str(), size);
+				sort(&values[0], &values[0] + size, CountedCompare<typename Traits::Key>(operations), Traits::projection());
+			}
+			else {
+				sort(&values[0], &values[0] + size, std::less<typename Traits::Key>(), Traits::projection());
+			}
+		}, [&]() { checkKeysOrder<T>(series.c_str(), &values[0], size); }, alsoSampled);
+	});
+}
+
+/**
+* calls workload((T*)NULL) with T the elements of --keys
+*/
+template <typename Workload>
+void withKeys(const Options &options, Workload workload) {
+	if (strcmp(options.keys, "int") == 0) {
+		workload((int*)NULL);
+	}
+	else if (strcmp(options.keys, "int64") == 0) {
+		workload((long long*)NULL);
+	}
+	else if (strcmp(options.keys, "double") == 0) {
+		workload((double*)NULL);
+	}
+	else if (strcmp(options.keys, "record") == 0) {
+		workload((Record*)NULL);
+	}
+	else {
+		throw "unknown key type";
+	}
+}
+
+/**
+* the workload of the sorts of the library: sort(first, last, comp, proj) on the elements of --keys.
+* with --count-accesses, the comparisons are counted with CountedCompare
+*/
+template <typename Sort>
+void libraryWorkload(const Options &options, const char *name, Sort sort) {
+	withKeys(options, [&](auto *keys) {
+		keyedWorkload<typename std::remove_pointer<decltype(keys)>::type>(options, name, sort);
+	});
+}
+
+void runLibrarySelectionSort(const Options &options) {
+	libraryWorkload(options, "sorting::selectionSort", [](auto first, auto last, auto comp, auto proj) {
+		sorting::selectionSort(first, last, comp, proj);
+	});
+}
+
+void runLibraryBubbleSort(const Options &options) {
+	libraryWorkload(options, "sorting::bubbleSort", [](auto first, auto last, auto comp, auto proj) {
+		sorting::bubbleSort(first, last, comp, proj);
+	});
+}
+
+void runLibraryInsertionSort(const Options &options) {
+	libraryWorkload(options, "sorting::insertionSort", [](auto first, auto last, auto comp, auto proj) {
+		sorting::insertionSort(first, last, comp, proj);
+	});
+}
+
+void runLibraryHeapSort(const Options &options) {
+	libraryWorkload(options, "sorting::heapSort", [](auto first, auto last, auto comp, auto proj) {
+		sorting::heapSort(first, last, comp, proj);
+	});
+}
+
+void runLibraryQuickSort(const Options &options) {
+	libraryWorkload(options, "sorting::quickSort", [](auto first, auto last, auto comp, auto proj) {
+		sorting::quickSort(first, last, comp, proj);
+	});
+}
+
+void runLibraryQuickSortRandomized(const Options &options) {
+	libraryWorkload(options, "sorting::quickSortRandomized", [](auto first, auto last, auto comp, auto proj) {
+		sorting::quickSortRandomized(first, last, comp, proj);
+	});
+}
+
+void runLibraryIntroSort(const Options &options) {
+	libraryWorkload(options, "sorting::introSort", [](auto first, auto last, auto comp, auto proj) {
+		sorting::introSort(first, last, comp, proj);
+	});
+}
+
+// a CountedCompare counts into one counter, from one thread
+void checkParallel(const Options &options) {
+	if (options.countAccesses) {
+		throw "the parallel sorts cannot count their comparisons";
+	}
+}
+
+void runParallelQuickSort(const Options &options) {
+	checkParallel(options);
+	libraryWorkload(options, "sorting::parallelQuickSort", [&options](auto first, auto last, auto comp, auto proj) {
+		sorting::parallelQuickSort(first, last, comp, proj, options.threads);
+	});
+}
+
+void runParallelSampleSort(const Options &options) {
+	checkParallel(options);
+	libraryWorkload(options, "sorting::parallelSampleSort", [&options](auto first, auto last, auto comp, auto proj) {
+		sorting::parallelSampleSort(first, last, comp, proj, options.threads);
+	});
+}
+
+/**
+* heapSort, quickSortRandomized and parallelSampleSort of the library on the int arrays of every distribution,
+* in one group per distribution. quickSortRandomized is quadratic on the distributions with many equal keys
+* (its partition puts the keys equal to the pivot on one side), --max must stay small enough for them
+*/
+void runSampleSortComparison(const Options &options) {
+	static const char *sorts[] = {"heapSort", "quickSortRandomized", "parallelSampleSort"};
+	InputBuffer<int> intArray(options);
+	BenchmarkRunner runner = createRunner(driverProfiler, options);
+
+	checkParallel(options);
+	for (int distribution = 0; distribution < NR_DISTRIBUTIONS; distribution++) {
+		Options distributed = options;
+		std::string kind = std::string(DistributionName(distribution)) + " array", series[3];
+
+		distributed.distribution = distribution;
+		for (int i = 0; i < 3; i++) {
+			series[i] = std::string("sorting::") + sorts[i] + " " + DistributionName(distribution);
+		}
+		sweep(options, [&](int size) {
+			int *first = &intArray[0];
+			for (int i = 0; i < 3; i++) {
+				warmInput(options, first, size);
+				runner.runChecked(series[i].c_str(), size, [&]() {
+					prepareArray(distributed, kind.c_str(), first, size, [&]() { fillArray(first, size, distributed); });
+				}, [&]() {
+					if (i == 0) {
+						sorting::heapSort(first, first + size);
+					}
+					else if (i == 1) {
+						sorting::quickSortRandomized(first, first + size);
+					}
+					else {
+						sorting::parallelSampleSort(first, first + size, std::less<>(), sorting::Identity(), options.threads);
+					}
+				}, [&]() { checkOrder(series[i].c_str(), isSorted(first, first + size)); });
+			}
+		});
+		driverProfiler.createGroup(DistributionName(distribution), series[0].c_str(), series[1].c_str(), series[2].c_str());
+	}
+}
+
+// the radix sorts make no comparison that a CountedCompare could count
+void checkRadix(const Options &options) {
+	if (options.countAccesses) {
+		throw "the radix sorts make no comparisons to count";
+	}
+}
+
+void runLsdRadixSort(const Options &options) {
+	checkRadix(options);
+	libraryWorkload(options, "sorting::lsdRadixSort", [&options](auto first, auto last, auto, auto proj) {
+		sorting::lsdRadixSort(first, last, proj, options.digitBits);
+	});
+}
+
+void runMsdRadixSort(const Options &options) {
+	checkRadix(options);
+	libraryWorkload(options, "sorting::msdRadixSort", [&options](auto first, auto last, auto, auto proj) {
+		sorting::msdRadixSort(first, last, proj, options.digitBits);
+	});
+}
+
+/**
+* heapSort, quickSortRandomized and the radix sorts of the library with 8, 11 and 16 bit digits (8 and 11 for
+* msdRadixSort), on int arrays of --distribution in three ranges: the range of the assignments, where most of
+* the high digits are the same, the positive ints and all the ints, in one group per range.
+* quickSortRandomized is quadratic on the many equal keys of the first range, --max must stay small enough for it
+*/
+void runRadixSortComparison(const Options &options) {
+	static const char *sorts[] = {"heapSort", "quickSortRandomized", "lsdRadixSort<8>", "lsdRadixSort<11>",
+								  "lsdRadixSort<16>", "msdRadixSort<8>", "msdRadixSort<11>"};
+	static const struct { const char *name; int min, max; } ranges[] = {
+		{ "10..50000", 10, 50000 }, { "0..INT_MAX", 0, INT_MAX }, { "INT_MIN..INT_MAX", INT_MIN, INT_MAX }
+	};
+	const int NR_SORTS = sizeof(sorts) / sizeof(sorts[0]);
+	InputBuffer<int> intArray(options);
+	BenchmarkRunner runner = createRunner(driverProfiler, options);
+
+	checkRadix(options);
+	for (int range = 0; range < 3; range++) {
+		std::string kind = std::string(ranges[range].name) + " array", series[NR_SORTS];
+
+		for (int i = 0; i < NR_SORTS; i++) {
+			series[i] = std::string("sorting::") + sorts[i] + " " + ranges[range].name;
+		}
+		sweep(options, [&](int size) {
+			int *first = &intArray[0];
+			for (int i = 0; i < NR_SORTS; i++) {
+				warmInput(options, first, size);
+				runner.runChecked(series[i].c_str(), size, [&]() {
+					prepareArray(options, kind.c_str(), first, size, [&]() {
+						FillDistributedArray(first, size, options.distribution, ranges[range].min, ranges[range].max,
+											 DefaultRandomGenerator());
+					});
+				}, [&]() {
+					switch (i) {
+					case 0: sorting::heapSort(first, first + size); break;
+					case 1: sorting::quickSortRandomized(first, first + size); break;
+					case 2: sorting::lsdRadixSort(first, first + size, sorting::Identity(), 8); break;
+					case 3: sorting::lsdRadixSort(first, first + size, sorting::Identity(), 11); break;
+					case 4: sorting::lsdRadixSort(first, first + size, sorting::Identity(), 16); break;
+					case 5: sorting::msdRadixSort(first, first + size, sorting::Identity(), 8); break;
+					default: sorting::msdRadixSort(first, first + size, sorting::Identity(), 11); break;
+					}
+				}, [&]() { checkOrder(series[i].c_str(), isSorted(first, first + size)); });
+			}
+		});
+		driverProfiler.createGroup(ranges[range].name, series[0].c_str(), series[1].c_str(), series[2].c_str(),
+			series[3].c_str(), series[4].c_str(), series[5].c_str(), series[6].c_str());
+	}
+}
+
+/**
+* sorts the --max elements of --keys on 1, 2, 4... threads, up to --threads (0 for every core): the size of the
+* points is the number of threads. the series name_speedup is the median time on 1 thread over the median time
+* on every number of threads, in percent, where the curve flattens the scaling stops
+*/
+template <typename T>
+void parallelScaling(const Options &options) {
+	typedef KeyTraits<T> Traits;
+	InputBuffer<T> values(options);
+	int size = options.maxSize;
+	int maxThreads = options.threads > 0 ? options.threads : std::max(1, (int)std::thread::hardware_concurrency());
+	std::string series = std::string("sorting::parallelQuickSort<") + options.keys + ">", speedup = series + "_speedup";
+	BenchmarkRunner runner = createRunner(driverProfiler, options);
+	std::vector<int> threadCounts;
+	std::vector<Profiler::OPCOUNT_MEASURE> medians;
+
+	for (int threads = 1; ; threads = std::min(2 * threads, maxThreads)) {
+		warmInput(options, &values[0], size);
+		runner.runChecked(series.c_str(), threads, [&]() { fillKeys(&values[0], size, options); }, [&]() {
+			sorting::parallelQuickSort(&values[0], &values[0] + size, std::less<typename Traits::Key>(),
+				Traits::projection(), threads);
+		}, [&]() { checkKeysOrder<T>(series.c_str(), &values[0], size); });
+		if (threads == maxThreads) {
+			break;
+		}
+	}
+
+	driverProfiler.seriesPoints((series + "_median").c_str(), Profiler::TIMES, threadCounts, medians);
+	for (size_t i = 0; i < threadCounts.size(); i++) {
+		driverProfiler.countOperation(speedup.c_str(), threadCounts[i], (int)(100.0 * medians[0] / std::max<Profiler::OPCOUNT_MEASURE>(medians[i], 1)));
+	}
+}
+
+void runParallelScaling(const Options &options) {
+	checkParallel(options);
+	withKeys(options, [&](auto *keys) {
+		parallelScaling<typename std::remove_pointer<decltype(keys)>::type>(options);
+	});
+}
+
+// the merged list holds the size elements of the k lists, sorted
+bool isSortedList(const kWayMerge::ListT *listRef, int size) {
+	int count = 0;
+	for (const kWayMerge::NodeT *node = listRef->first; node; node = node->next, count++) {
+		if (node->next && node->next->value < node->value) {
+			return false;
+		}
+	}
+	return count == size && listRef->nrElements == size;
+}
+
+/**
+* merges k sorted lists of size / k elements (the first lists get one more if it does not divide)
+*/
+void runKWayMerge(const Options &options) {
+	using namespace kWayMerge;
+	InputBuffer<int> intArray(options);
+	std::vector<ListT*> listArray(options.k);
+	BenchmarkRunner runner = createRunner(profiler, options);
+
+	if (options.k < 1 || options.k > MAX_NR_OF_LISTS || options.minSize < options.k) {
+		throw "k-way-merge needs 1 <= k <= 1000 and at least k elements";
+	}
+	for (int i = 0; i < options.k; i++) {
+		listArray[i] = createListHead();
+	}
+	sweep(options, [&](int size) {
+		ListT *sortedList = NULL;
+		auto prepare = [&]() {
+			if (sortedList) {
+				deallocateList(sortedList);
+				TrackedFree(sortedList);
+			}
+			prepareLists(options, &intArray[0], size, &listArray[0]);
+		};
+
+		auto check = [&]() { checkOrder("mergeOperations", isSortedList(sortedList, size)); };
+
+		if (options.countAccesses) {
+			runner.runCounted("mergeOperations", size, prepare, [&](CountedOperations<> &operations) {
+				sortedList = mergeListsCounted(options.k, &listArray[0], size, operations);
+			}, check);
+		}
+		else {
+			runner.runChecked("mergeOperations", size, prepare, [&]() {
+				sortedList = mergeLists(options.k, &listArray[0], size);
+			}, check);
+		}
+
+		deallocateList(sortedList);
+		TrackedFree(sortedList);
+	});
+	for (int i = 0; i < options.k; i++) {
+		deallocateList(listArray[i]);
+		TrackedFree(listArray[i]);
+	}
+}
+
+/**
+* fills a table of the given size up to the filling factor, then searches every key that was inserted.
+* the insertions are only counted (with their allocations), the searches are measured
+*/
+void runHashTable(const Options &options) {
+	using namespace hashTable;
+	InputBuffer<int> keys(options);
+	char name[30] = "Benchmark";
+	BenchmarkRunner runner = createRunner(profiler, options);
+
+	sweep(options, [&](int size) {
+		HashTableT *table = NULL;
+		int inserted = 0;
+
+		runner.run("searchOperations", size, [&]() {
+			if (table) {
+				purgeHashTable(table);
+			}
+			table = createHashTable(hashingFunction, size);
+			// the table only takes positive ids
+			prepareArray(options, "keys", &keys[0], size, [&]() {
+				FillDistributedArray(&keys[0], size, options.distribution, 1, 10 * size, DefaultRandomGenerator());
+			});
+			DefaultOperation o = profiler.createCounter<DefaultOperation>("insertions", size);
+			for (inserted = 0; inserted < size && (double)table->nrElements / size < options.fillFactor; inserted++) {
+				insertHashTable(table, keys[inserted], name);
+				o.count();
+			}
+		}, [&]() {
+			DefaultOperation o = profiler.createCounter<DefaultOperation>("searchOperations", size);
+			int operations;
+
+			for (int i = 0; i < inserted; i++) {
+				findHashTable(table, keys[i], name, &operations);
+				o.count(operations);
+			}
+		}, { "insertions" });
+
+		purgeHashTable(table);
+	});
+}
+
+/**
+* builds a balanced tree of size nodes, then selects and deletes random positions until it is empty
+*/
+void runOrderStatistics(const Options &options) {
+	using namespace orderStatistics;
+	BenchmarkRunner runner = createRunner(profiler, options);
+
+	sweep(options, [&](int size) {
+		runner.run("Avg Case Analysis", size, [&]() {
+			DefaultOperation o = profiler.createCounter<DefaultOperation>("Avg Case Analysis", size);
+			int *inputArray = buildArray(size), itemsLeft = size;
+			TreeNode *tree = buildBalancedTree(inputArray, 0, size - 1, &o);
+
+			for (int j = 0; j < size; j++) {
+				int randomKey = (int)DefaultRandomGenerator().bounded(itemsLeft--) + 1;
+				TreeNode *selectedNode = options.cache.levelCount() > 0 ?
+					(TreeNode*)selectNode(SimulatedPointer<TreeNode>(tree), randomKey, &o) : selectNode(tree, randomKey, &o);
+				tree = deleteNode(tree, selectedNode, &o);
+			}
+
+			purgeTree(&tree);
+			free(inputArray);
+		});
+	});
+}
+
+/**
+* the connected graph of kruskal with size vertices, replayed from the workload file or generated and saved
+*/
+disjointSets::GraphT *prepareGraph(const Options &options, int size) {
+	using namespace disjointSets;
+	std::string name = inputName("edges", size);
+	GraphT *graph;
+
+	if (options.snapshot) {
+		WorkloadSnapshot::EdgeList edges = options.snapshot->edges(name.c_str());
+		if (edges.nrVertices != size) {
+			throw "the workload file does not match the sweep";
+		}
+		graph = newGraph(size, (int)edges.nrEdges);
+		for (size_t i = 0; i < edges.nrEdges; i++) {
+			graph->edges[i] = createNewEdge(edges.edges[i].source, edges.edges[i].destination, edges.edges[i].weight);
+		}
+		return graph;
+	}
+	graph = createGraph(size, 4 * size);
+	if (options.snapshotWriter && !options.snapshotWriter->contains(name.c_str())) {
+		std::vector<SnapshotEdge> edges(graph->nrEdges);
+		for (int i = 0; i < graph->nrEdges; i++) {
+			SnapshotEdge edge = { graph->edges[i]->source, graph->edges[i]->destination, graph->edges[i]->weight };
+			edges[i] = edge;
+		}
+		options.snapshotWriter->writeEdges(name.c_str(), size, &edges[0], edges.size());
+	}
+	return graph;
+}
+
+/**
+* builds the minimum spanning tree of a connected graph of size vertices and 4 * size edges
+*/
+void runKruskal(const Options &options) {
+	using namespace disjointSets;
+	std::vector<NodeT*> setsArray(options.maxSize > 0 ? options.maxSize : 1);
+	BenchmarkRunner runner = createRunner(profiler, options);
+
+	sweep(options, [&](int size) {
+		GraphT *graph = NULL, *MST = NULL;
+
+		runner.run("kruskalOperations", size, [&]() {
+			if (graph) {
+				freeSets(&setsArray[0], size);
+				freeGraph(graph);
+				free(MST->edges);
+				free(MST);
+			}
+			graph = prepareGraph(options, size);
+		}, [&]() {
+			DefaultOperation o = profiler.createCounter<DefaultOperation>("kruskalOperations", size);
+			buildAllSets(size, &setsArray[0], &o);
+			MST = kruskal(graph, &setsArray[0], &o);
+		});
+
+		freeSets(&setsArray[0], size);
+		freeGraph(graph);
+		// the edges of the MST belong to the graph
+		free(MST->edges);
+		free(MST);
+	});
+}
+
+/**
+* the random graph of bfs and dfs, replayed from the workload file or generated and saved. the file keeps every
+* adjacency list in order (an undirected edge is in both lists), so that a replayed graph is traversed the same way
+*/
+template <typename Graph, typename Create, typename Generate>
+Graph *prepareAdjacencyGraph(const Options &options, int size, Create createGraph, Generate generate) {
+	char name[64];
+	Graph *graph;
+
+	snprintf(name, sizeof(name), "graph %d %d", options.vertices, size);
+	if (options.snapshot) {
+		WorkloadSnapshot::EdgeList arcs = options.snapshot->edges(name);
+		graph = createGraph(arcs.nrVertices, size);
+		for (size_t i = 0; i < arcs.nrEdges; i++) {
+			graph->nodeLists[arcs.edges[i].source]->adjNodes.push_back(arcs.edges[i].destination);
+		}
+		return graph;
+	}
+	graph = generate(options.vertices, size);
+	if (options.snapshotWriter && !options.snapshotWriter->contains(name)) {
+		std::vector<SnapshotEdge> arcs;
+		for (int i = 0; i < graph->nrVertices; i++) {
+			for (int adjacent : graph->nodeLists[i]->adjNodes) {
+				SnapshotEdge arc = { i, adjacent, 0 };
+				arcs.push_back(arc);
+			}
+		}
+		options.snapshotWriter->writeEdges(name, graph->nrVertices, arcs.empty() ? NULL : &arcs[0], arcs.size());
+	}
+	return graph;
+}
+
+/**
+* traverses a random graph of the given number of vertices, with size edges
+*/
+template <typename Graph, typename Generate, typename Traverse, typename Free>
+void graphWorkload(const Options &options, Profiler &profiler, const char *name, long long maxEdges,
+				   Generate generate, Traverse traverse, Free freeGraph) {
+	BenchmarkRunner runner = createRunner(profiler, options);
+
+	if (options.vertices < 2 || options.maxSize > maxEdges) {
+		throw "there are not enough vertices for the number of edges";
+	}
+	sweep(options, [&](int size) {
+		Graph *graph = NULL;
+
+		runner.run(name, size, [&]() {
+			if (graph) {
+				freeGraph(graph);
+			}
+			graph = generate(options.vertices, size);
+		}, [&]() {
+			DefaultOperation o = profiler.createCounter<DefaultOperation>(name, size);
+			traverse(graph, &o);
+		});
+
+		freeGraph(graph);
+	});
+}
+
+void runBFS(const Options &options) {
+	using namespace breadthFirstSearch;
+	graphWorkload<GraphT>(options, profiler, "bfsOperations", (long long)options.vertices * (options.vertices - 1) / 2,
+		[&options](int, int size) { return prepareAdjacencyGraph<GraphT>(options, size, createGraph, generateRandomGraph); },
+		[](GraphT *graph, DefaultOperation *o) { unconnectedBFS(graph, o); }, freeGraph);
+}
+
+void runDFS(const Options &options) {
+	using namespace depthFirstSearch;
+	graphWorkload<GraphT>(options, profiler, "dfsOperations", (long long)options.vertices * (options.vertices - 1),
+		[&options](int, int size) { return prepareAdjacencyGraph<GraphT>(options, size, createGraph, generateRandomGraph); },
+		[](GraphT *graph, DefaultOperation *o) { unconnectedDFS(graph, o); }, freeGraph);
+}
+
+const Workload workloads[] = {
+	{ "selection-sort", "selection sort (assignment 1)", &directSorting::profiler, runSelectionSort },
+	{ "bubble-sort", "bubble sort (assignment 1)", &directSorting::profiler, runBubbleSort },
+	{ "insertion-sort", "insertion sort (assignment 1)", &directSorting::profiler, runInsertionSort },
+	{ "build-heap-top-down", "top down heap construction (assignment 2)", &buildHeap::profiler, runBuildHeapTopDown },
+	{ "build-heap-bottom-up", "bottom up heap construction (assignment 2)", &buildHeap::profiler, runBuildHeapBottomUp },
+	{ "heap-sort", "heapsort (assignment 3)", &advancedSorting::profiler, runHeapSort },
+	{ "quick-sort", "quicksort with the last element as pivot (assignment 3)", &advancedSorting::profiler, runQuickSort },
+	{ "quick-sort-randomized", "quicksort with a random pivot (assignment 3)", &advancedSorting::profiler, runQuickSortRandomized },
+	{ "quick-sort-adaptive", "pattern-defeating quicksort, falls back to heapsort (assignment 3)", &advancedSorting::profiler,
+	  runQuickSortAdaptive },
+	{ "adaptive-comparison", "quick-sort, quick-sort-randomized and quick-sort-adaptive on partly ordered inputs",
+	  &advancedSorting::profiler, runAdaptiveComparison },
+	{ "partition-comparison", "quick-sort-randomized with the lomuto and the block partition, with hardware counters",
+	  &advancedSorting::profiler, runPartitionComparison },
+	{ "duplicate-keys-comparison", "quick-sort-randomized with every partition, on few-unique, many-duplicates and zipf",
+	  &advancedSorting::profiler, runDuplicateKeysComparison },
+	{ "std-sort", "std::sort, as a reference (only the comparisons are counted)", &driverProfiler, runStdSort },
+	{ "library-selection-sort", "selection sort of the sorting library, on --keys", &driverProfiler, runLibrarySelectionSort },
+	{ "library-bubble-sort", "bubble sort of the sorting library, on --keys", &driverProfiler, runLibraryBubbleSort },
+	{ "library-insertion-sort", "insertion sort of the sorting library, on --keys", &driverProfiler, runLibraryInsertionSort },
+	{ "library-heap-sort", "heapsort of the sorting library, on --keys", &driverProfiler, runLibraryHeapSort },
+	{ "library-quick-sort", "quicksort of the sorting library, last element pivot, on --keys", &driverProfiler, runLibraryQuickSort },
+	{ "library-quick-sort-randomized", "quicksort of the sorting library, random pivot, on --keys", &driverProfiler,
+	  runLibraryQuickSortRandomized },
+	{ "library-intro-sort", "introsort of the sorting library (ninther pivots, heapsort below 2 log n), on --keys",
+	  &driverProfiler, runLibraryIntroSort },
+	{ "parallel-quick-sort", "introsort of the sorting library on --threads threads (work stealing), on --keys",
+	  &driverProfiler, runParallelQuickSort },
+	{ "parallel-scaling", "parallel-quick-sort of --max elements over 1, 2, 4... --threads threads, with the speedup",
+	  &driverProfiler, runParallelScaling },
+	{ "parallel-sample-sort", "super scalar sample sort of the sorting library on --threads threads, on --keys",
+	  &driverProfiler, runParallelSampleSort },
+	{ "sample-sort-comparison", "library heapsort, randomized quicksort and sample sort on ints, every distribution",
+	  &driverProfiler, runSampleSortComparison },
+	{ "library-lsd-radix-sort", "least significant digit first radix sort of --digit-bits bits, on --keys",
+	  &driverProfiler, runLsdRadixSort },
+	{ "library-msd-radix-sort", "most significant digit first radix sort of --digit-bits bits, on --keys",
+	  &driverProfiler, runMsdRadixSort },
+	{ "radix-sort-comparison", "library heapsort, randomized quicksort and radix sorts on 3 ranges of ints",
+	  &driverProfiler, runRadixSortComparison },
+	{ "k-way-merge", "merge of k sorted lists with a heap, size elements in total (assignment 4)", &kWayMerge::profiler, runKWayMerge },
+	{ "hash-table", "search in a quadratic probing table of size slots (assignment 5)", &hashTable::profiler, runHashTable },
+	{ "order-statistics", "select and delete in an augmented tree (assignment 6)", &orderStatistics::profiler, runOrderStatistics },
+	{ "kruskal", "kruskal with disjoint sets, size vertices (assignment 8)", &disjointSets::profiler, runKruskal },
+	{ "bfs", "breadth first search, size edges (assignment 9)", &breadthFirstSearch::profiler, runBFS },
+	{ "dfs", "depth first search, size edges (assignment 10)", &depthFirstSearch::profiler, runDFS },
+};
+const int NR_WORKLOADS = sizeof(workloads) / sizeof(workloads[0]);
+
+void printUsage(void) {
+	fprintf(stderr, "usage: \"Benchmark Driver\" --algorithm NAME [--min N] [--max N] [--step N | --factor F]\n"
+					"\t[--distribution NAME] [--reps N] [--min-reps N] [--confidence C] [--error E] [--threads N] [--seed S]\n"
+					"\t[--format html|csv|jsonl|binary] [--output FILE] [--k K] [--vertices V] [--fill F]\n"
+					"\t[--save-baseline FILE] [--baseline FILE] [--tolerance T] [--track-allocations]\n"
+					"\t[--simulate-cache | --cache SIZE:WAYS:LINE,...] [--count-accesses] [--hardware-counters]\n"
+					"\t[--partition lomuto|block|three-way|dual-pivot]\n"
+					"\t[--trace FILE] [--folded FILE] [--folded-operations FILE]\n"
+					"\t[--pin CORE] [--warmup N] [--caches cold|warm] [--huge-pages]\n"
+					"\t[--keys int|int64|double|record] [--digit-bits B] [--save-workload FILE | --workload FILE]\n"
+					"       \"Benchmark Driver\" --list\n");
+}
+
+void printList(void) {
+	printf("algorithms:\n");
+	for (int i = 0; i < NR_WORKLOADS; i++) {
+		printf("\t%-32s%s\n", workloads[i].name, workloads[i].description);
+	}
+	printf("distributions:\n");
+	for (int i = 0; i < NR_DISTRIBUTIONS; i++) {
+		printf("\t%s\n", DistributionName(i));
+	}
+}
+
+/**
+* reads the levels of a cache, given as capacity:associativity:line size, separated by commas
+*/
+void parseCache(const char *spec, CacheSimulator &cache) {
+	cache = CacheSimulator();
+	while (*spec) {
+		unsigned long long capacity;
+		int associativity, lineSize, length;
+
+		if (sscanf(spec, "%llu:%d:%d%n", &capacity, &associativity, &lineSize, &length) != 3) {
+			throw "the cache levels are given as SIZE:WAYS:LINE,...";
+		}
+		cache.addLevel((size_t)capacity, associativity, lineSize);
+		spec += length;
+		if (*spec == ',') {
+			spec++;
+		}
+	}
+}
+
+/**
+* reads the options, returns false if they are not valid
+*/
+bool parseOptions(int argc, char *argv[], Options &options, BenchmarkIsolation &isolation) {
+	options.algorithm = NULL;
+	options.format = "html";
+	options.keys = "int";
+	options.output = NULL;
+	options.baseline = options.saveBaseline = NULL;
+	options.trace = options.foldedTimes = options.foldedOperations = NULL;
+	options.trackAllocations = false;
+	options.countAccesses = false;
+	options.hugePages = false;
+	options.hardwareCounters = false;
+	options.partition = advancedSorting::LOMUTO_PARTITION;
+	options.isolation = &isolation;
+	options.savedWorkload = options.replayedWorkload = NULL;
+	options.snapshot = NULL;
+	options.snapshotWriter = NULL;
+	options.distribution = UNIFORM;
+	options.minSize = 100;
+	options.maxSize = 10000;
+	options.step = 100;
+	options.factor = 0;
+	options.minSamples = 5;
+	options.maxSamples = 100;
+	options.threads = 0;
+	options.k = 10;
+	options.vertices = 100;
+	options.digitBits = 8;
+	options.confidence = 0.95;
+	options.relativeError = 0.02;
+	options.tolerance = 0.1;
+	options.fillFactor = 0.95;
+
+	for (int i = 1; i < argc; i++) {
+		const char *flag = argv[i], *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(flag, "--list") == 0) {
+			printList();
+			exit(EXIT_SUCCESS);
+		}
+		if (strcmp(flag, "--track-allocations") == 0) {
+			options.trackAllocations = true;
+			continue;
+		}
+		if (strcmp(flag, "--count-accesses") == 0) {
+			options.countAccesses = true;
+			continue;
+		}
+		if (strcmp(flag, "--huge-pages") == 0) {
+			options.hugePages = true;
+			continue;
+		}
+		if (strcmp(flag, "--hardware-counters") == 0) {
+			options.hardwareCounters = true;
+			continue;
+		}
+		if (strcmp(flag, "--simulate-cache") == 0) {
+			options.cache = CacheSimulator::typical();
+			continue;
+		}
+		if (!value) {
+			return false;
+		}
+		i++;
+		if (strcmp(flag, "--algorithm") == 0) options.algorithm = value;
+		else if (strcmp(flag, "--min") == 0) options.minSize = atoi(value);
+		else if (strcmp(flag, "--max") == 0) options.maxSize = atoi(value);
+		else if (strcmp(flag, "--step") == 0) options.step = atoi(value);
+		else if (strcmp(flag, "--factor") == 0) options.factor = atof(value);
+		else if (strcmp(flag, "--distribution") == 0) options.distribution = FindDistribution(value);
+		else if (strcmp(flag, "--reps") == 0) options.maxSamples = atoi(value);
+		else if (strcmp(flag, "--min-reps") == 0) options.minSamples = atoi(value);
+		else if (strcmp(flag, "--confidence") == 0) options.confidence = atof(value);
+		else if (strcmp(flag, "--error") == 0) options.relativeError = atof(value);
+		else if (strcmp(flag, "--threads") == 0) options.threads = atoi(value);
+		else if (strcmp(flag, "--seed") == 0) SetRandomSeed(strtoull(value, NULL, 10));
+		else if (strcmp(flag, "--format") == 0) options.format = value;
+		else if (strcmp(flag, "--output") == 0) options.output = value;
+		else if (strcmp(flag, "--k") == 0) options.k = atoi(value);
+		else if (strcmp(flag, "--vertices") == 0) options.vertices = atoi(value);
+		else if (strcmp(flag, "--fill") == 0) options.fillFactor = atof(value);
+		else if (strcmp(flag, "--digit-bits") == 0) options.digitBits = atoi(value);
+		else if (strcmp(flag, "--partition") == 0) {
+			if (strcmp(value, "lomuto") == 0) options.partition = advancedSorting::LOMUTO_PARTITION;
+			else if (strcmp(value, "block") == 0) options.partition = advancedSorting::BLOCK_PARTITION;
+			else if (strcmp(value, "three-way") == 0) options.partition = advancedSorting::THREE_WAY_PARTITION;
+			else if (strcmp(value, "dual-pivot") == 0) options.partition = advancedSorting::DUAL_PIVOT_PARTITION;
+			else return false;
+		}
+		else if (strcmp(flag, "--save-baseline") == 0) options.saveBaseline = value;
+		else if (strcmp(flag, "--baseline") == 0) options.baseline = value;
+		else if (strcmp(flag, "--tolerance") == 0) options.tolerance = atof(value);
+		else if (strcmp(flag, "--cache") == 0) parseCache(value, options.cache);
+		else if (strcmp(flag, "--trace") == 0) options.trace = value;
+		else if (strcmp(flag, "--folded") == 0) options.foldedTimes = value;
+		else if (strcmp(flag, "--folded-operations") == 0) options.foldedOperations = value;
+		else if (strcmp(flag, "--pin") == 0) isolation.setCore(atoi(value));
+		else if (strcmp(flag, "--warmup") == 0) isolation.setWarmups(atoi(value));
+		else if (strcmp(flag, "--caches") == 0) isolation.setCacheState(BenchmarkIsolation::findCacheState(value));
+		else if (strcmp(flag, "--keys") == 0) options.keys = value;
+		else if (strcmp(flag, "--save-workload") == 0) options.savedWorkload = value;
+		else if (strcmp(flag, "--workload") == 0) options.replayedWorkload = value;
+		else return false;
+	}
+
+	if (options.countAccesses && options.cache.levelCount() > 0) {
+		throw "the accesses cannot be counted and simulated in the same run";
+	}
+	if (options.savedWorkload && options.replayedWorkload) {
+		throw "a workload cannot be saved and replayed in the same run";
+	}
+	if (options.minSamples > options.maxSamples) {
+		options.minSamples = options.maxSamples;
+	}
+	return options.algorithm && options.minSize > 0 && options.minSize <= options.maxSize && (options.step > 0 || options.factor > 1)
+		&& options.maxSamples > 0;
+}
+
+int main(int argc, char *argv[]) {
+	Options options;
+	BenchmarkIsolation isolation;
+	std::unique_ptr<WorkloadSnapshot> snapshot;
+	std::unique_ptr<WorkloadWriter> snapshotWriter;
+	const Workload *workload = NULL;
+	int regressions = 0;
+
+	try {
+		if (!parseOptions(argc, argv, options, isolation)) {
+			printUsage();
+			return EXIT_FAILURE;
+		}
+		for (int i = 0; i < NR_WORKLOADS; i++) {
+			if (strcmp(workloads[i].name, options.algorithm) == 0) {
+				workload = &workloads[i];
+			}
+		}
+		if (!workload) {
+			throw "unknown algorithm, see --list";
+		}
+		if (options.replayedWorkload) {
+			snapshot.reset(new WorkloadSnapshot(options.replayedWorkload));
+			options.snapshot = snapshot.get();
+		}
+		if (options.savedWorkload) {
+			snapshotWriter.reset(new WorkloadWriter(options.savedWorkload));
+			options.snapshotWriter = snapshotWriter.get();
+		}
+
+		Profiler &profiler = *workload->profiler;
+		profiler.reset(workload->name);
+		profiler.trackAllocations(options.trackAllocations);
+		if (options.hardwareCounters && !profiler.enableHardwareCounters()) {
+			fprintf(stderr, "warning: the hardware counters are not available\n");
+		}
+		if (options.cache.levelCount() > 0) {
+			profiler.simulateCache(options.cache);
+		}
+		profiler.recordScopes(options.trace || options.foldedTimes || options.foldedOperations);
+		if (strcmp(options.format, "csv") == 0) {
+			profiler.streamReport(options.output ? options.output : "benchmark.csv", Profiler::CSV_REPORT);
+		}
+		else if (strcmp(options.format, "jsonl") == 0) {
+			profiler.streamReport(options.output ? options.output : "benchmark.jsonl", Profiler::JSON_LINES_REPORT);
+		}
+		else if (strcmp(options.format, "binary") == 0) {
+			profiler.streamReport(options.output ? options.output : "benchmark.bin", Profiler::BINARY_REPORT);
+		}
+		else if (strcmp(options.format, "html") != 0) {
+			throw "unknown format";
+		}
+		if (&profiler == &driverProfiler) {
+			// the leaves of the sorts of the library on ints go through the sorting networks of this instruction set
+			profiler.describeEnvironment("sorting networks", sorting::sortingNetworkInstructions());
+		}
+
+		workload->run(options);
+		if (snapshotWriter) {
+			snapshotWriter->close();
+		}
+		if (options.trace) {
+			profiler.writeChromeTrace(options.trace);
+		}
+		if (options.foldedTimes) {
+			profiler.writeFoldedStacks(options.foldedTimes, Profiler::TIMES);
+		}
+		if (options.foldedOperations) {
+			profiler.writeFoldedStacks(options.foldedOperations, Profiler::OPCOUNT);
+		}
+
+		ComplexityAnalysis analysis(profiler);
+		if (options.saveBaseline) {
+			analysis.saveBaseline(options.saveBaseline);
+		}
+		if (options.baseline) {
+			regressions = analysis.compareBaseline(options.baseline, options.tolerance);
+		}
+		if (strcmp(options.format, "html") == 0) {
+			profiler.showReport();
+		}
+	}
+	catch (const char *error) {
+		fprintf(stderr, "error: %s\n", error);
+		return EXIT_FAILURE;
+	}
+
+	return regressions > 0 ? 2 : EXIT_SUCCESS;
+}
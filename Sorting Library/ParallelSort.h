@@ -0,0 +1,469 @@
+#ifndef _PARALLEL_SORT_H
+#define _PARALLEL_SORT_H
+
+/**
+ * Parallel sorts
+ *
+ * The sorts of Sorting.h spread over several threads, with the same iterators, comparators and projections.
+ * The comparator and the projection are called from every thread at once, so they must not keep a state
+ * (a CountedCompare does) and must not throw.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include "Sorting.h"
+
+namespace sorting {
+
+/**
+* the tasks a thread waits for: spawned into it, and finished when pending drops back to 0
+*/
+class TaskGroup {
+public:
+	TaskGroup() : pending(0) {}
+
+private:
+	friend class WorkStealingPool;
+	std::atomic<long> pending;
+
+	TaskGroup(const TaskGroup&);
+	TaskGroup& operator=(const TaskGroup&);
+};
+
+/**
+* a pool of threads with a deque of tasks each. a thread runs the newest task of its own deque and, once it is
+* empty, steals the oldest task of another one: the oldest tasks are the largest parts of a divide and conquer.
+* the thread that creates the pool is one of its threads, it runs tasks while it waits for a group, and only
+* it can spawn tasks from outside of a task
+*/
+class WorkStealingPool {
+public:
+	/**
+	* threads counts the creating thread, 0 for every core of the machine
+	*/
+	explicit WorkStealingPool(int threads = 0) : stopping(false) {
+		int count = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+
+		count = count > 0 ? count : 1;
+		for (int i = 0; i < count; i++) {
+			queues.push_back(std::unique_ptr<Queue>(new Queue()));
+		}
+		previous = current();
+		current() = Registration(this, 0);
+		for (int i = 1; i < count; i++) {
+			workers.push_back(std::thread([this, i]() { work(i); }));
+		}
+	}
+
+	~WorkStealingPool() {
+		stopping = true;
+		for (size_t i = 0; i < workers.size(); i++) {
+			workers[i].join();
+		}
+		current() = previous;
+	}
+
+	int size() const {
+		return (int)queues.size();
+	}
+
+	/**
+	* adds task to the deque of the calling thread, as part of group
+	*/
+	template <typename Task>
+	void spawn(TaskGroup &group, Task task) {
+		Queue &queue = *queues[self()];
+		Entry entry;
+
+		entry.run = task;
+		entry.group = &group;
+		group.pending++;
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.tasks.push_back(std::move(entry));
+	}
+
+	/**
+	* runs tasks, of the group or not, until every task of the group has finished
+	*/
+	void wait(TaskGroup &group) {
+		int index = self();
+		while (group.pending.load() > 0) {
+			if (!runOne(index)) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	struct Entry {
+		std::function<void()> run;
+		TaskGroup *group;
+	};
+
+	struct Queue {
+		std::mutex lock;
+		std::deque<Entry> tasks;
+	};
+
+	typedef std::pair<WorkStealingPool*, int> Registration;
+
+	std::vector<std::unique_ptr<Queue> > queues;
+	std::vector<std::thread> workers;
+	std::atomic<bool> stopping;
+	// the pool the creating thread belonged to before, if pools are nested
+	Registration previous;
+
+	static Registration &current() {
+		static thread_local Registration registration(NULL, 0);
+		return registration;
+	}
+
+	int self() const {
+		if (current().first != this) {
+			throw "only the threads of a pool can spawn its tasks";
+		}
+		return current().second;
+	}
+
+	void work(int index) {
+		current() = Registration(this, index);
+		while (!stopping) {
+			if (!runOne(index)) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool runOne(int index) {
+		Entry entry;
+		if (!take(index, entry)) {
+			return false;
+		}
+		entry.run();
+		entry.group->pending--;
+		return true;
+	}
+
+	bool take(int index, Entry &entry) {
+		for (int i = 0; i < size(); i++) {
+			Queue &queue = *queues[(index + i) % size()];
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (queue.tasks.empty()) {
+				continue;
+			}
+			// the own deque is used as a stack, the others as queues
+			if (i == 0) {
+				entry = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+			}
+			else {
+				entry = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+			}
+			return true;
+		}
+		return false;
+	}
+
+	WorkStealingPool(const WorkStealingPool&);
+	WorkStealingPool& operator=(const WorkStealingPool&);
+};
+
+namespace detail {
+
+/**
+* partitions [first, last) with the threads of the pool and returns the split: pred holds before it, not from it on.
+* every thread partitions a chunk on its own, then the elements left on the wrong side of the split are
+* swapped pairwise, the k-th misplaced element before the split with the k-th one after it
+*/
+template <typename Iterator, typename Predicate>
+Iterator parallelPartition(WorkStealingPool &pool, Iterator first, Iterator last, Predicate pred) {
+	typedef typename std::iterator_traits<Iterator>::difference_type Difference;
+	typedef std::pair<Difference, Difference> Interval;
+	Difference size = last - first, chunk = (size + pool.size() - 1) / pool.size(), split = 0;
+	int chunks = (int)((size + chunk - 1) / chunk);
+	std::vector<Difference> splits(chunks);
+	std::vector<Interval> wrongBefore, wrongAfter;
+	TaskGroup group;
+
+	for (int i = 0; i < chunks; i++) {
+		Difference begin = i * chunk, end = std::min(size, begin + chunk);
+		pool.spawn(group, [first, begin, end, i, &splits, &pred]() {
+			splits[i] = std::partition(first + begin, first + end, pred) - first;
+		});
+	}
+	pool.wait(group);
+
+	for (int i = 0; i < chunks; i++) {
+		split += splits[i] - i * chunk;
+	}
+	// the chunks are in order, so are the intervals
+	for (int i = 0; i < chunks; i++) {
+		Difference begin = i * chunk, end = std::min(size, begin + chunk);
+		if (splits[i] < split && std::min(end, split) > splits[i]) {
+			wrongBefore.push_back(Interval(splits[i], std::min(end, split)));
+		}
+		if (splits[i] > split && splits[i] > std::max(begin, split)) {
+			wrongAfter.push_back(Interval(std::max(begin, split), splits[i]));
+		}
+	}
+
+	Difference misplaced = 0;
+	for (size_t i = 0; i < wrongBefore.size(); i++) {
+		misplaced += wrongBefore[i].second - wrongBefore[i].first;
+	}
+	Difference share = (misplaced + pool.size() - 1) / pool.size();
+	for (Difference start = 0; start < misplaced; start += share) {
+		pool.spawn(group, [first, start, share, misplaced, &wrongBefore, &wrongAfter]() {
+			Difference count = std::min(share, misplaced - start);
+			size_t before = 0, after = 0;
+			Difference skipBefore = start, skipAfter = start;
+
+			// finds the start-th misplaced element on both sides
+			while (skipBefore >= wrongBefore[before].second - wrongBefore[before].first) {
+				skipBefore -= wrongBefore[before].second - wrongBefore[before].first;
+				before++;
+			}
+			while (skipAfter >= wrongAfter[after].second - wrongAfter[after].first) {
+				skipAfter -= wrongAfter[after].second - wrongAfter[after].first;
+				after++;
+			}
+			Difference i = wrongBefore[before].first + skipBefore, j = wrongAfter[after].first + skipAfter;
+			while (count-- > 0) {
+				std::iter_swap(first + i, first + j);
+				if (++i == wrongBefore[before].second && count > 0) {
+					i = wrongBefore[++before].first;
+				}
+				if (++j == wrongAfter[after].second && count > 0) {
+					j = wrongAfter[++after].first;
+				}
+			}
+		});
+	}
+	pool.wait(group);
+	return first + split;
+}
+
+/**
+* below PARALLEL_GRAIN elements a part is sorted by introSort on one thread. the partitions of at least
+* PARALLEL_PARTITION_CHUNK elements per thread of the pool are partitioned by all the threads
+*/
+const int PARALLEL_GRAIN = 1 << 14;
+const int PARALLEL_PARTITION_CHUNK = 1 << 16;
+
+template <typename Iterator, typename Less>
+void parallelQuickSort(WorkStealingPool &pool, TaskGroup &group, Iterator first, Iterator last, int depthLimit, Less &less) {
+	while (last - first > PARALLEL_GRAIN) {
+		Iterator left = first, right;
+
+		if (depthLimit == 0) {
+			detail::heapSort(first, last, less);
+			return;
+		}
+		depthLimit--;
+
+		detail::movePivotToFirst(first, last, less);
+		if (pool.size() > 1 && last - first >= (long long)pool.size() * PARALLEL_PARTITION_CHUNK) {
+			Iterator pivot = first, split = detail::parallelPartition(pool, first + 1, last, [pivot, &less](
+				typename std::iterator_traits<Iterator>::reference value) { return less(value, *pivot); });
+
+			if (split == first + 1) {
+				// nothing is less than the pivot: it and the elements equal to it are in place
+				first = detail::parallelPartition(pool, first + 1, last, [pivot, &less](
+					typename std::iterator_traits<Iterator>::reference value) { return !less(*pivot, value); });
+				continue;
+			}
+			std::iter_swap(first, split - 1);
+			right = split;
+			first = split - 1;
+		}
+		else {
+			right = detail::hoarePartition(first, last, less);
+			first = right;
+		}
+		// the left part goes to the deque, where an idle thread can steal it
+		pool.spawn(group, [&pool, &group, left, first, depthLimit, &less]() {
+			detail::parallelQuickSort(pool, group, left, first, depthLimit, less);
+		});
+		first = right;
+	}
+	detail::introSort(first, last, depthLimit, less);
+}
+
+/**
+* the sample sort splits into up to 1 << SAMPLE_SORT_MAX_LOG_BUCKETS buckets, with SAMPLE_SORT_OVERSAMPLING samples
+* per bucket. the elements are classified SAMPLE_SORT_BLOCK at a time: the descents of the elements of a block
+* through the tree of splitters do not depend on each other, so the comparisons of a level overlap in the
+* pipeline instead of waiting for each other, and a block and its buckets stay in the L1 cache
+*/
+const int SAMPLE_SORT_MAX_LOG_BUCKETS = 8;
+const int SAMPLE_SORT_OVERSAMPLING = 16;
+const int SAMPLE_SORT_BLOCK = 1024;
+
+/**
+* stores the sorted splitters as a complete binary search tree, in breadth first order from node 1
+*/
+template <typename Iterator>
+void buildSplitterTree(std::vector<Iterator> &tree, int node, Iterator *splitters, int count) {
+	if (count == 0) {
+		return;
+	}
+	tree[node] = splitters[count / 2];
+	detail::buildSplitterTree(tree, 2 * node, splitters, count / 2);
+	detail::buildSplitterTree(tree, 2 * node + 1, splitters + count / 2 + 1, count / 2);
+}
+
+/**
+* writes the bucket of every element of [first, last) to buckets and counts them: bucket b holds the elements
+* greater than the splitter b - 1 and not greater than the splitter b
+*/
+template <typename Iterator, typename Less>
+void classify(Iterator first, Iterator last, const std::vector<Iterator> &tree, int logBuckets, Less &less,
+			  unsigned char *buckets, size_t *counts) {
+	unsigned short nodes[SAMPLE_SORT_BLOCK];
+
+	while (first != last) {
+		int block = (int)std::min<typename std::iterator_traits<Iterator>::difference_type>(SAMPLE_SORT_BLOCK, last - first);
+
+		std::fill(nodes, nodes + block, 1);
+		for (int level = 0; level < logBuckets; level++) {
+			for (int i = 0; i < block; i++) {
+				nodes[i] = (unsigned short)(2 * nodes[i] + less(*tree[nodes[i]], first[i]));
+			}
+		}
+		for (int i = 0; i < block; i++) {
+			buckets[i] = (unsigned char)(nodes[i] - (1 << logBuckets));
+			counts[buckets[i]]++;
+		}
+		first += block;
+		buckets += block;
+	}
+}
+
+template <typename Iterator, typename Less>
+void parallelSampleSort(WorkStealingPool &pool, Iterator first, Iterator last, Less &less) {
+	typedef typename std::iterator_traits<Iterator>::difference_type Difference;
+	typedef typename std::iterator_traits<Iterator>::value_type Value;
+	Difference size = last - first;
+	int logBuckets = std::min(SAMPLE_SORT_MAX_LOG_BUCKETS, detail::floorLog2(size / PARALLEL_GRAIN));
+	int nrBuckets = 1 << logBuckets, threads = pool.size();
+	int sampleSize = nrBuckets * SAMPLE_SORT_OVERSAMPLING;
+	Difference stripe = (size + threads - 1) / threads;
+	std::vector<Iterator> splitters(nrBuckets - 1), tree(nrBuckets);
+	std::vector<unsigned char> buckets(size);
+	std::vector<size_t> counts((size_t)threads * nrBuckets), starts(nrBuckets + 1);
+	TaskGroup group;
+
+	// the sample is drawn to the front of the array and stays there while the rest is classified against it
+	for (int i = 0; i < sampleSize; i++) {
+		std::iter_swap(first + i, first + i + (Difference)(nextRandom() % (unsigned long long)(size - i)));
+	}
+	detail::introSort(first, first + sampleSize, 2 * detail::floorLog2(sampleSize), less);
+	for (int i = 0; i < nrBuckets - 1; i++) {
+		splitters[i] = first + (i + 1) * SAMPLE_SORT_OVERSAMPLING - 1;
+	}
+	detail::buildSplitterTree(tree, 1, &splitters[0], nrBuckets - 1);
+
+	for (int t = 0; t < threads; t++) {
+		Difference begin = std::min(size, t * stripe), end = std::min(size, begin + stripe);
+		pool.spawn(group, [&, t, begin, end]() {
+			detail::classify(first + begin, first + end, tree, logBuckets, less, &buckets[begin], &counts[t * nrBuckets]);
+		});
+	}
+	pool.wait(group);
+
+	// the elements of a bucket go in the order of the stripes: counts[t][b] becomes where stripe t writes into bucket b
+	size_t position = 0;
+	for (int b = 0; b < nrBuckets; b++) {
+		starts[b] = position;
+		for (int t = 0; t < threads; t++) {
+			size_t count = counts[t * nrBuckets + b];
+			counts[t * nrBuckets + b] = position;
+			position += count;
+		}
+	}
+	starts[nrBuckets] = position;
+
+	Value *buffer = static_cast<Value*>(::operator new(size * sizeof(Value)));
+	for (int t = 0; t < threads; t++) {
+		Difference begin = std::min(size, t * stripe), end = std::min(size, begin + stripe);
+		pool.spawn(group, [&, t, begin, end]() {
+			size_t *positions = &counts[t * nrBuckets];
+			for (Difference i = begin; i < end; i++) {
+				new (buffer + positions[buckets[i]]++) Value(std::move(first[i]));
+			}
+		});
+	}
+	pool.wait(group);
+
+	// the buckets larger than a thread's share (the keys repeated many times) are sorted by all the threads
+	for (int b = 0; b < nrBuckets; b++) {
+		pool.spawn(group, [&, b]() {
+			Iterator begin = first + starts[b], end = first + starts[b + 1];
+			for (size_t i = starts[b]; i < starts[b + 1]; i++) {
+				first[i] = std::move(buffer[i]);
+				buffer[i].~Value();
+			}
+			if (end - begin > stripe && end - begin > PARALLEL_GRAIN) {
+				TaskGroup parts;
+				detail::parallelQuickSort(pool, parts, begin, end, 2 * detail::floorLog2(end - begin), less);
+				pool.wait(parts);
+			}
+			else {
+				detail::introSort(begin, end, 2 * detail::floorLog2(end - begin), less);
+			}
+		});
+	}
+	pool.wait(group);
+	::operator delete(buffer);
+}
+
+}
+
+/**
+* introsort on threads threads (0 for every core): the large partitions are partitioned in parallel, and the parts
+* are sorted by the threads of a work stealing pool, down to parts of PARALLEL_GRAIN elements
+*/
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void parallelQuickSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection(), int threads = 0) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+
+	if (last - first <= detail::PARALLEL_GRAIN) {
+		detail::introSort(first, last, 2 * detail::floorLog2(last - first), less);
+		return;
+	}
+	WorkStealingPool pool(threads);
+	TaskGroup group;
+	detail::parallelQuickSort(pool, group, first, last, 2 * detail::floorLog2(last - first), less);
+	pool.wait(group);
+}
+
+/**
+* super scalar sample sort on threads threads (0 for every core), for the arrays too large for the caches:
+* up to 256 buckets are chosen from a sorted sample, every thread classifies a stripe of the array through the
+* tree of splitters and moves its elements to their buckets in a buffer of the size of the array, then the
+* buckets are moved back and sorted by introSort, in parallel. O(n log n) comparisons, and only a few passes
+* over the memory instead of the log2(n / grain) of a quicksort
+*/
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void parallelSampleSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection(), int threads = 0) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+
+	if (last - first < 2 * detail::PARALLEL_GRAIN) {
+		detail::introSort(first, last, 2 * detail::floorLog2(last - first), less);
+		return;
+	}
+	WorkStealingPool pool(threads);
+	detail::parallelSampleSort(pool, first, last, less);
+}
+
+}
+
+#endif
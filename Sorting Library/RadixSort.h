@@ -0,0 +1,251 @@
+#ifndef _RADIX_SORT_H
+#define _RADIX_SORT_H
+
+/**
+ * Radix sorts
+ *
+ * Sorts by the digits of a key instead of comparisons, for the elements whose key (the element itself, or what
+ * the projection gives, as in Sorting.h) is an integer or a floating point number. The key is turned into an
+ * unsigned integer of 32 or 64 bits that has the same order (see RadixKey), and the digits are digitBits of it:
+ *	8	256 counters, that stay in the L1 cache: the default
+ *	11	2048 counters, 32 bit keys in 3 passes instead of 4
+ *	16	65536 counters, 32 bit keys in 2 passes, for the arrays of millions of elements and lsdRadixSort only
+ * any width from 1 to 16 bits works.
+ */
+
+#include <string.h>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "Sorting.h"
+
+namespace sorting {
+
+/**
+* the unsigned integer of a key, in the order of the keys: the sign bit of the signed integers is flipped, so
+* that the negative ones come first, and the bits of the negative floating point numbers are all flipped, so
+* that the larger magnitudes come first. -0.0 comes before 0.0, and the NaNs at both ends, by their sign
+*/
+template <typename Key, bool integral = std::is_integral<Key>::value>
+struct RadixKey {
+	typedef typename std::conditional<sizeof(Key) <= 4, unsigned int, unsigned long long>::type Bits;
+
+	static Bits bits(Key key) {
+		// the smaller signed types are sign extended first, which keeps their order
+		Bits bits = (Bits)key;
+		return std::is_signed<Key>::value ? bits ^ ((Bits)1 << (8 * sizeof(Bits) - 1)) : bits;
+	}
+};
+
+template <typename Key>
+struct RadixKey<Key, false> {
+	static_assert(std::is_floating_point<Key>::value && (sizeof(Key) == 4 || sizeof(Key) == 8),
+				  "the keys of a radix sort are integers, floats or doubles");
+	typedef typename std::conditional<sizeof(Key) == 4, unsigned int, unsigned long long>::type Bits;
+
+	static Bits bits(Key key) {
+		const Bits sign = (Bits)1 << (8 * sizeof(Bits) - 1);
+		Bits bits;
+
+		memcpy(&bits, &key, sizeof(bits));
+		return (bits & sign) ? ~bits : bits | sign;
+	}
+};
+
+namespace detail {
+
+/**
+* the unsigned key of the elements through the projection, and the comparison of these keys for insertionSort
+*/
+template <typename Iterator, typename Projection>
+class RadixLess {
+public:
+	typedef typename std::decay<decltype(detail::project(std::declval<const Projection&>(),
+														 *std::declval<Iterator&>()))>::type Key;
+	typedef typename RadixKey<Key>::Bits Bits;
+
+	RadixLess(Projection givenProj) : proj(givenProj) {}
+
+	template <typename T, typename U>
+	bool operator()(T &a, U &b) {
+		return bits(a) < bits(b);
+	}
+
+	template <typename T>
+	Bits bits(T &value) {
+		return RadixKey<Key>::bits(detail::project(proj, value));
+	}
+
+private:
+	Projection proj;
+};
+
+/**
+* the buckets of at most RADIX_INSERTION_CUTOFF elements are left to insertionSort, the counters of a digit
+* would cost more than the sort
+*/
+const int RADIX_INSERTION_CUTOFF = 64;
+
+inline void checkDigitBits(int digitBits) {
+	if (digitBits < 1 || digitBits > 16) {
+		throw "the digits of a radix sort have 1 to 16 bits";
+	}
+}
+
+template <typename Iterator, typename Projection>
+void lsdRadixSort(Iterator first, Iterator last, Projection &proj, int digitBits) {
+	typedef typename std::iterator_traits<Iterator>::value_type Value;
+	typedef typename RadixLess<Iterator, Projection>::Bits Bits;
+	RadixLess<Iterator, Projection> less(proj);
+	size_t size = last - first, radix = (size_t)1 << digitBits, mask = radix - 1;
+	int passes = (8 * (int)sizeof(Bits) + digitBits - 1) / digitBits;
+
+	if (size <= (size_t)RADIX_INSERTION_CUTOFF) {
+		detail::insertionSort(first, last, less);
+		return;
+	}
+	// one pass over the keys counts the digits of every pass
+	std::vector<size_t> counts(passes * radix);
+	for (Iterator i = first; i != last; ++i) {
+		Bits bits = less.bits(*i);
+		for (int pass = 0; pass < passes; pass++) {
+			counts[pass * radix + ((bits >> (pass * digitBits)) & mask)]++;
+		}
+	}
+
+	// the elements go back and forth between the array and the buffer, whose elements are constructed by the first pass
+	Value *buffer = static_cast<Value*>(::operator new(size * sizeof(Value)));
+	bool inBuffer = false, constructed = false;
+	for (int pass = 0; pass < passes; pass++) {
+		size_t *offsets = &counts[pass * radix], sum = 0;
+		int shift = pass * digitBits;
+
+		// a digit that is the same in every key leaves the order as it is
+		if (offsets[(less.bits(inBuffer ? buffer[0] : first[0]) >> shift) & mask] == size) {
+			continue;
+		}
+		for (size_t digit = 0; digit < radix; digit++) {
+			size_t count = offsets[digit];
+			offsets[digit] = sum;
+			sum += count;
+		}
+		if (inBuffer) {
+			for (size_t i = 0; i < size; i++) {
+				first[offsets[(less.bits(buffer[i]) >> shift) & mask]++] = std::move(buffer[i]);
+			}
+		}
+		else {
+			for (size_t i = 0; i < size; i++) {
+				Value *target = buffer + offsets[(less.bits(first[i]) >> shift) & mask]++;
+				if (constructed) {
+					*target = std::move(first[i]);
+				}
+				else {
+					new (target) Value(std::move(first[i]));
+				}
+			}
+			constructed = true;
+		}
+		inBuffer = !inBuffer;
+	}
+
+	if (inBuffer) {
+		std::move(buffer, buffer + size, first);
+	}
+	for (size_t i = 0; constructed && i < size; i++) {
+		buffer[i].~Value();
+	}
+	::operator delete(buffer);
+}
+
+/**
+* sorts [first, last) by the digit at shift and the ones below it. counts holds 2 * radix counters for every
+* digit of the key, so that no call allocates
+*/
+template <typename Iterator, typename Projection>
+void msdRadixSort(Iterator first, Iterator last, RadixLess<Iterator, Projection> &less, int shift, int digitBits, size_t *counts) {
+	size_t size = last - first, radix = (size_t)1 << digitBits, mask = radix - 1;
+
+	while (size > (size_t)RADIX_INSERTION_CUTOFF) {
+		size_t *heads = counts, *tails = counts + radix, sum = 0;
+
+		std::fill(tails, tails + radix, 0);
+		for (Iterator i = first; i != last; ++i) {
+			tails[(less.bits(*i) >> shift) & mask]++;
+		}
+		// a digit that is the same in every key leaves the elements in one bucket: the next digit decides
+		if (tails[(less.bits(*first) >> shift) & mask] == size) {
+			if (shift == 0) {
+				return;
+			}
+			shift = std::max(0, shift - digitBits);
+			continue;
+		}
+		for (size_t digit = 0; digit < radix; digit++) {
+			heads[digit] = sum;
+			sum += tails[digit];
+			tails[digit] = sum;
+		}
+
+		// american flag sort: every element is swapped straight into the next free slot of its bucket
+		for (size_t digit = 0; digit < radix; digit++) {
+			while (heads[digit] < tails[digit]) {
+				size_t target = (less.bits(first[heads[digit]]) >> shift) & mask;
+				if (target == digit) {
+					heads[digit]++;
+				}
+				else {
+					std::iter_swap(first + heads[digit], first + heads[target]++);
+				}
+			}
+		}
+		if (shift == 0) {
+			return;
+		}
+		for (size_t digit = 0, begin = 0; digit < radix; begin = tails[digit++]) {
+			if (tails[digit] - begin > 1) {
+				detail::msdRadixSort(first + begin, first + tails[digit], less, std::max(0, shift - digitBits), digitBits,
+									 counts + 2 * radix);
+			}
+		}
+		return;
+	}
+	detail::insertionSort(first, last, less);
+}
+
+}
+
+/**
+* least significant digit first: one pass over the keys counts every digit, then every digit that is not the same
+* in all the keys moves the elements to a buffer of the size of the array, or back, in the order of the digit.
+* stable, O(n) for every pass, and the elements only need to be move constructible and move assignable
+*/
+template <typename Iterator, typename Projection = Identity>
+void lsdRadixSort(Iterator first, Iterator last, Projection proj = Projection(), int digitBits = 8) {
+	detail::checkDigitBits(digitBits);
+	detail::lsdRadixSort(first, last, proj, digitBits);
+}
+
+/**
+* most significant digit first, in place: the elements are permuted into the buckets of the highest digit, then
+* every bucket is sorted by the next digits on its own, down to insertionSort for the small ones. not stable;
+* it stops as soon as the buckets are small, so the short prefixes of the keys decide most of the order
+*/
+template <typename Iterator, typename Projection = Identity>
+void msdRadixSort(Iterator first, Iterator last, Projection proj = Projection(), int digitBits = 8) {
+	typedef typename detail::RadixLess<Iterator, Projection>::Bits Bits;
+	detail::RadixLess<Iterator, Projection> less(proj);
+	int bitCount = 8 * (int)sizeof(Bits);
+
+	detail::checkDigitBits(digitBits);
+	if (last - first < 2) {
+		return;
+	}
+	int digits = (bitCount + digitBits - 1) / digitBits;
+	std::vector<size_t> counts(digits * ((size_t)2 << digitBits));
+	detail::msdRadixSort(first, last, less, std::max(0, bitCount - digitBits), digitBits, &counts[0]);
+}
+
+}
+
+#endif
@@ -0,0 +1,434 @@
+#ifndef _SORTING_H
+#define _SORTING_H
+
+/**
+ * Sorting library
+ *
+ * The sorts of assignments 1 to 3 for any random access iterators, instead of int arrays. The elements are
+ * compared with comp(proj(a), proj(b)): comp defaults to operator<, and the projection proj to the element itself.
+ * A projection is a callable or a pointer to a data member, so that records are sorted by one of their fields:
+ *
+ *	sorting::heapSort(records.begin(), records.end(), std::less<long long>(), &Record::key);
+ *
+ * The elements are moved, never copied, so they only need to be move constructible and move assignable.
+ * Nothing is counted here, unlike in the assignments: the comparisons can be counted with a CountedCompare
+ * (see Profiler.h) given as comp.
+ */
+
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SortingNetworks.h"
+
+namespace sorting {
+
+/**
+* the projection that leaves the element as it is
+*/
+struct Identity {
+	template <typename T>
+	T &&operator()(T &&value) const {
+		return std::forward<T>(value);
+	}
+};
+
+namespace detail {
+
+template <typename Projection, typename T>
+auto project(const Projection &proj, T &value) -> decltype(proj(value)) {
+	return proj(value);
+}
+
+template <typename Member, typename Class, typename T>
+const Member &project(Member Class::*member, T &value) {
+	return value.*member;
+}
+
+/**
+* the comparison of two elements through the projection. the internal functions take it by reference,
+* so that a comparator with a state (one that counts, for instance) sees every comparison. they call each
+* other with detail:: so that the lookup that depends on the arguments does not find std:: or the public sorts
+*/
+template <typename Compare, typename Projection>
+class ProjectedCompare {
+public:
+	ProjectedCompare(Compare givenComp, Projection givenProj) : comp(givenComp), proj(givenProj) {}
+
+	template <typename T, typename U>
+	bool operator()(T &a, U &b) {
+		return comp(project(proj, a), project(proj, b));
+	}
+
+private:
+	Compare comp;
+	Projection proj;
+};
+
+/**
+* splitmix64, one state per thread, for the random pivots. the sequence is the same in every run
+*/
+inline unsigned long long nextRandom() {
+	static thread_local unsigned long long state = 0x9E3779B97F4A7C15ULL;
+	unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+template <typename Iterator, typename Less>
+void selectionSort(Iterator first, Iterator last, Less &less) {
+	for (Iterator i = first; i != last; ++i) {
+		Iterator minimum = i;
+		for (Iterator j = i + 1; j != last; ++j) {
+			if (less(*j, *minimum)) {
+				minimum = j;
+			}
+		}
+		if (minimum != i) {
+			std::iter_swap(i, minimum);
+		}
+	}
+}
+
+template <typename Iterator, typename Less>
+void bubbleSort(Iterator first, Iterator last, Less &less) {
+	// everything after the last swap of a pass is in place, the next pass stops there
+	while (last - first > 1) {
+		Iterator lastSwap = first;
+		for (Iterator i = first + 1; i != last; ++i) {
+			if (less(*i, *(i - 1))) {
+				std::iter_swap(i, i - 1);
+				lastSwap = i;
+			}
+		}
+		last = lastSwap;
+	}
+}
+
+template <typename Iterator, typename Less>
+void insertionSort(Iterator first, Iterator last, Less &less) {
+	typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+	if (first == last) {
+		return;
+	}
+	for (Iterator i = first + 1; i != last; ++i) {
+		Value value = std::move(*i);
+		Iterator j = i;
+
+		// as long as the element to insert is < the elements to its left, they are moved to the right by 1 position
+		for (; j != first && less(value, *(j - 1)); --j) {
+			*j = std::move(*(j - 1));
+		}
+		*j = std::move(value);
+	}
+}
+
+/**
+* the leaves of quickSort and introSort: the ints of an array compared by operator< are sorted by a network
+* (see SortingNetworks.h), without the mispredicted branches of insertionSort, everything else by insertionSort
+*/
+template <typename Compare>
+struct IsIntLess : std::false_type {};
+
+template <>
+struct IsIntLess<std::less<> > : std::true_type {};
+
+template <>
+struct IsIntLess<std::less<int> > : std::true_type {};
+
+template <typename Iterator, typename Less>
+struct UsesNetwork : std::false_type {};
+
+template <typename Compare>
+struct UsesNetwork<int*, ProjectedCompare<Compare, Identity> > : IsIntLess<Compare> {};
+
+template <typename Compare>
+struct UsesNetwork<std::vector<int>::iterator, ProjectedCompare<Compare, Identity> > : IsIntLess<Compare> {};
+
+template <typename Iterator, typename Less>
+void sortLeaf(Iterator first, Iterator last, Less &less, std::false_type) {
+	detail::insertionSort(first, last, less);
+}
+
+template <typename Iterator, typename Less>
+void sortLeaf(Iterator first, Iterator last, Less &, std::true_type) {
+	if (last - first > 1) {
+		sortSmallInts(&*first, (int)(last - first));
+	}
+}
+
+template <typename Iterator, typename Less>
+void sortLeaf(Iterator first, Iterator last, Less &less) {
+	detail::sortLeaf(first, last, less, UsesNetwork<Iterator, Less>());
+}
+
+/**
+* the leaves that go through a network are cut at NETWORK_CUTOFF elements instead of the cutoff of their sort:
+* on 2 * 10^6 random ints, quickSortRandomized takes about 10% less time and introSort about 5% less than with
+* their own cutoffs and insertionSort, while a network of 8 for the leaves of 5 of quickSort was slower
+*/
+const int NETWORK_CUTOFF = 32;
+
+template <typename Iterator, typename Less>
+int leafCutoff(int cutoff) {
+	return UsesNetwork<Iterator, Less>::value ? NETWORK_CUTOFF : cutoff;
+}
+
+/**
+* moves value down from the hole at index hole of the heap of size elements, until both its children are not greater
+*/
+template <typename Iterator, typename Less>
+void siftDown(Iterator first, typename std::iterator_traits<Iterator>::difference_type hole,
+			  typename std::iterator_traits<Iterator>::difference_type size,
+			  typename std::iterator_traits<Iterator>::value_type value, Less &less) {
+	typename std::iterator_traits<Iterator>::difference_type child;
+
+	while ((child = 2 * hole + 1) < size) {
+		if (child + 1 < size && less(first[child], first[child + 1])) {
+			child++;
+		}
+		if (!less(value, first[child])) {
+			break;
+		}
+		first[hole] = std::move(first[child]);
+		hole = child;
+	}
+	first[hole] = std::move(value);
+}
+
+template <typename Iterator, typename Less>
+void heapSort(Iterator first, Iterator last, Less &less) {
+	typedef typename std::iterator_traits<Iterator>::value_type Value;
+	typename std::iterator_traits<Iterator>::difference_type size = last - first, i;
+
+	// bottom up construction: the leaves are heaps, the parents are sifted down from the last one
+	for (i = size / 2 - 1; i >= 0; i--) {
+		Value value = std::move(first[i]);
+		detail::siftDown(first, i, size, std::move(value), less);
+	}
+	// the maximum goes to the end, the last element takes its place at the root
+	for (i = size - 1; i > 0; i--) {
+		Value value = std::move(first[i]);
+		first[i] = std::move(first[0]);
+		detail::siftDown(first, 0, i, std::move(value), less);
+	}
+}
+
+/**
+* Lomuto partition around the last element: returns its final position, the elements before it are not greater
+*/
+template <typename Iterator, typename Less>
+Iterator partition(Iterator first, Iterator last, Less &less) {
+	Iterator pivot = last - 1, store = first;
+
+	for (Iterator i = first; i != pivot; ++i) {
+		if (!less(*pivot, *i)) {
+			std::iter_swap(store, i);
+			++store;
+		}
+	}
+	std::iter_swap(store, pivot);
+	return store;
+}
+
+/**
+* the quicksorts of assignment 3: partitions of at most QUICKSORT_CUTOFF elements are left to insertionSort
+* (see sortLeaf for the ints).
+* the recursion goes into the smaller side and loops on the larger one, so that the stack stays logarithmic
+* even when the pivots make the time quadratic
+*/
+const int QUICKSORT_CUTOFF = 5;
+
+template <typename Iterator, typename Less>
+void quickSort(Iterator first, Iterator last, Less &less, bool randomPivot) {
+	const int cutoff = detail::leafCutoff<Iterator, Less>(QUICKSORT_CUTOFF);
+
+	while (last - first > cutoff) {
+		if (randomPivot) {
+			std::iter_swap(first + (nextRandom() % (unsigned long long)(last - first)), last - 1);
+		}
+		Iterator pivot = detail::partition(first, last, less);
+
+		if (pivot - first < last - pivot) {
+			detail::quickSort(first, pivot, less, randomPivot);
+			first = pivot + 1;
+		}
+		else {
+			detail::quickSort(pivot + 1, last, less, randomPivot);
+			last = pivot;
+		}
+	}
+	detail::sortLeaf(first, last, less);
+}
+
+/**
+* sorts *a, *b and *c
+*/
+template <typename Iterator, typename Less>
+void sort3(Iterator a, Iterator b, Iterator c, Less &less) {
+	if (less(*b, *a)) {
+		std::iter_swap(a, b);
+	}
+	if (less(*c, *b)) {
+		std::iter_swap(b, c);
+		if (less(*b, *a)) {
+			std::iter_swap(a, b);
+		}
+	}
+}
+
+/**
+* moves the pivot of the partition to *first: the median of 3 elements, or above NINTHER_THRESHOLD elements
+* Tukey's ninther, the median of the medians of 3 spread triples. the samples are taken after first, so that
+* an element not less and an element not greater than the pivot stay in [first + 1, last) as sentinels
+*/
+const int NINTHER_THRESHOLD = 128;
+
+template <typename Iterator, typename Less>
+void movePivotToFirst(Iterator first, Iterator last, Less &less) {
+	typename std::iterator_traits<Iterator>::difference_type size = last - first;
+	Iterator middle = first + size / 2;
+
+	if (size > NINTHER_THRESHOLD) {
+		detail::sort3(first + 1, first + 2, first + 3, less);
+		detail::sort3(middle - 1, middle, middle + 1, less);
+		detail::sort3(last - 3, last - 2, last - 1, less);
+		detail::sort3(first + 2, middle, last - 2, less);
+	}
+	else {
+		detail::sort3(first + 1, middle, last - 1, less);
+	}
+	std::iter_swap(first, middle);
+}
+
+/**
+* Hoare partition around *first, without bound checks (see movePivotToFirst). both scans stop at the elements
+* equal to the pivot, so that many equal keys are split evenly. returns the start of the second part:
+* no element before it is greater than the pivot, no element from it on is less
+*/
+template <typename Iterator, typename Less>
+Iterator hoarePartition(Iterator first, Iterator last, Less &less) {
+	Iterator pivot = first;
+
+	++first;
+	while (true) {
+		while (less(*first, *pivot)) {
+			++first;
+		}
+		--last;
+		while (less(*pivot, *last)) {
+			--last;
+		}
+		if (!(first < last)) {
+			return first;
+		}
+		std::iter_swap(first, last);
+		++first;
+	}
+}
+
+/**
+* partitions of at most INTROSORT_CUTOFF elements are left to insertionSort (see sortLeaf for the ints). on random
+* ints, cutoffs from 16 to 32 take the same time within the noise; 24 leaves some room for elements that are more
+* expensive to move
+*/
+const int INTROSORT_CUTOFF = 24;
+
+template <typename Iterator, typename Less>
+void introSort(Iterator first, Iterator last, int depthLimit, Less &less) {
+	const int cutoff = detail::leafCutoff<Iterator, Less>(INTROSORT_CUTOFF);
+
+	while (last - first > cutoff) {
+		// the pivots have been bad too many times: heapSort keeps the time in O(n log n)
+		if (depthLimit == 0) {
+			detail::heapSort(first, last, less);
+			return;
+		}
+		depthLimit--;
+
+		detail::movePivotToFirst(first, last, less);
+		Iterator cut = detail::hoarePartition(first, last, less);
+
+		if (cut - first < last - cut) {
+			detail::introSort(first, cut, depthLimit, less);
+			first = cut;
+		}
+		else {
+			detail::introSort(cut, last, depthLimit, less);
+			last = cut;
+		}
+	}
+	detail::sortLeaf(first, last, less);
+}
+
+template <typename Size>
+int floorLog2(Size size) {
+	int log = 0;
+	while (size > 1) {
+		size >>= 1;
+		log++;
+	}
+	return log;
+}
+
+}
+
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void selectionSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::selectionSort(first, last, less);
+}
+
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void bubbleSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::bubbleSort(first, last, less);
+}
+
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void insertionSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::insertionSort(first, last, less);
+}
+
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void heapSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::heapSort(first, last, less);
+}
+
+/**
+* quicksort around the last element of every partition: quadratic on sorted inputs, as in assignment 3
+*/
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void quickSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::quickSort(first, last, less, false);
+}
+
+/**
+* quicksort around a random element of every partition
+*/
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void quickSortRandomized(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::quickSort(first, last, less, true);
+}
+
+/**
+* introsort: quicksort around a median of 3 (a ninther for the large partitions) that switches to heapSort
+* below a depth of 2 log2(n), and leaves the small partitions to insertionSort. O(n log n) in the worst case,
+* with the constants of quicksort
+*/
+template <typename Iterator, typename Compare = std::less<>, typename Projection = Identity>
+void introSort(Iterator first, Iterator last, Compare comp = Compare(), Projection proj = Projection()) {
+	detail::ProjectedCompare<Compare, Projection> less(comp, proj);
+	detail::introSort(first, last, 2 * detail::floorLog2(last - first), less);
+}
+
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef _SORTING_NETWORKS_H
+#define _SORTING_NETWORKS_H
+
+/**
+ * Sorting networks
+ *
+ * Bitonic sorting networks for 8, 16, 32 and 64 ints, with AVX2, with SSE4.1 or without vectors, whichever the
+ * processor supports (chosen once, at the first sort). A network makes the same comparisons whatever the values,
+ * so it has no branch to mispredict, unlike insertionSort. sortSmallInts sorts up to 64 ints with the smallest
+ * network that holds them, the rest of the network filled with INT_MAX; it is the leaf of quickSort and introSort
+ * (see Sorting.h) for the arrays of ints.
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SORTING_NETWORKS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// msvc compiles the intrinsics of any instruction set without flags
+#define SORTING_TARGET(isa)
+#else
+#define SORTING_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace sorting {
+
+namespace detail {
+
+/**
+* the bitonic network of SIZE elements: for every k = 2, 4... SIZE and every j = k / 2... 1, the element i and
+* the element i ^ j are exchanged if they are out of the order of the block of k elements that holds them,
+* ascending if i & k is 0 and descending otherwise. the last block is the whole array, in ascending order
+*/
+template <int SIZE>
+void bitonicScalar(int *values) {
+	for (int k = 2; k <= SIZE; k <<= 1) {
+		for (int j = k >> 1; j > 0; j >>= 1) {
+			for (int i = 0; i < SIZE; i++) {
+				if (i & j) {
+					continue;
+				}
+				int a = values[i], b = values[i + j];
+				int low = a < b ? a : b, high = a < b ? b : a;
+				values[i] = (i & k) ? high : low;
+				values[i + j] = (i & k) ? low : high;
+			}
+		}
+	}
+}
+
+#ifdef SORTING_NETWORKS_X86
+
+/**
+* the same network, 8 elements at a time. the exchanges between elements at least 8 apart take whole vectors,
+* the ones inside a vector exchange it with its permutation and keep the minimum or the maximum in every lane
+*/
+template <int SIZE>
+SORTING_TARGET("avx2")
+void bitonicAvx2(int *values) {
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), zero = _mm256_setzero_si256();
+
+	for (int k = 2; k <= SIZE; k <<= 1) {
+		for (int j = k >> 1; j > 0; j >>= 1) {
+			if (j >= 8) {
+				for (int i = 0; i < SIZE; i += 8) {
+					if (i & j) {
+						continue;
+					}
+					__m256i a = _mm256_loadu_si256((__m256i*)(values + i)), b = _mm256_loadu_si256((__m256i*)(values + i + j));
+					__m256i low = _mm256_min_epi32(a, b), high = _mm256_max_epi32(a, b);
+					_mm256_storeu_si256((__m256i*)(values + i), (i & k) ? high : low);
+					_mm256_storeu_si256((__m256i*)(values + i + j), (i & k) ? low : high);
+				}
+				continue;
+			}
+			const __m256i partners = _mm256_xor_si256(lanes, _mm256_set1_epi32(j));
+			for (int i = 0; i < SIZE; i += 8) {
+				__m256i index = _mm256_add_epi32(lanes, _mm256_set1_epi32(i));
+				// a lane keeps the minimum if it is the lower one of its pair in an ascending block, or the upper one in a descending block
+				__m256i lower = _mm256_cmpeq_epi32(_mm256_and_si256(index, _mm256_set1_epi32(j)), zero);
+				__m256i ascending = _mm256_cmpeq_epi32(_mm256_and_si256(index, _mm256_set1_epi32(k)), zero);
+				__m256i keepMinimum = _mm256_cmpeq_epi32(lower, ascending);
+				__m256i v = _mm256_loadu_si256((__m256i*)(values + i)), w = _mm256_permutevar8x32_epi32(v, partners);
+				_mm256_storeu_si256((__m256i*)(values + i),
+									_mm256_blendv_epi8(_mm256_max_epi32(v, w), _mm256_min_epi32(v, w), keepMinimum));
+			}
+		}
+	}
+}
+
+/**
+* the same network, 4 elements at a time
+*/
+template <int SIZE>
+SORTING_TARGET("sse4.1")
+void bitonicSse41(int *values) {
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3), zero = _mm_setzero_si128();
+
+	for (int k = 2; k <= SIZE; k <<= 1) {
+		for (int j = k >> 1; j > 0; j >>= 1) {
+			if (j >= 4) {
+				for (int i = 0; i < SIZE; i += 4) {
+					if (i & j) {
+						continue;
+					}
+					__m128i a = _mm_loadu_si128((__m128i*)(values + i)), b = _mm_loadu_si128((__m128i*)(values + i + j));
+					__m128i low = _mm_min_epi32(a, b), high = _mm_max_epi32(a, b);
+					_mm_storeu_si128((__m128i*)(values + i), (i & k) ? high : low);
+					_mm_storeu_si128((__m128i*)(values + i + j), (i & k) ? low : high);
+				}
+				continue;
+			}
+			for (int i = 0; i < SIZE; i += 4) {
+				__m128i index = _mm_add_epi32(lanes, _mm_set1_epi32(i));
+				__m128i lower = _mm_cmpeq_epi32(_mm_and_si128(index, _mm_set1_epi32(j)), zero);
+				__m128i ascending = _mm_cmpeq_epi32(_mm_and_si128(index, _mm_set1_epi32(k)), zero);
+				__m128i keepMinimum = _mm_cmpeq_epi32(lower, ascending);
+				__m128i v = _mm_loadu_si128((__m128i*)(values + i));
+				__m128i w = j == 1 ? _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)) : _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+				_mm_storeu_si128((__m128i*)(values + i), _mm_blendv_epi8(_mm_max_epi32(v, w), _mm_min_epi32(v, w), keepMinimum));
+			}
+		}
+	}
+}
+
+inline bool supportsAvx2() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	// avx needs the operating system to save the ymm registers
+	if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool supportsSse41() {
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+#else
+	return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+#endif
+
+/**
+* the networks of 8, 16, 32 and 64 elements of the best instruction set of the processor
+*/
+struct NetworkKernels {
+	void (*sort[4])(int *values);
+	const char *instructions;
+
+	NetworkKernels() {
+#ifdef SORTING_NETWORKS_X86
+		if (supportsAvx2()) {
+			set(bitonicAvx2<8>, bitonicAvx2<16>, bitonicAvx2<32>, bitonicAvx2<64>, "avx2");
+			return;
+		}
+		if (supportsSse41()) {
+			set(bitonicSse41<8>, bitonicSse41<16>, bitonicSse41<32>, bitonicSse41<64>, "sse4.1");
+			return;
+		}
+#endif
+		set(bitonicScalar<8>, bitonicScalar<16>, bitonicScalar<32>, bitonicScalar<64>, "scalar");
+	}
+
+	void set(void (*sort8)(int*), void (*sort16)(int*), void (*sort32)(int*), void (*sort64)(int*), const char *name) {
+		sort[0] = sort8;
+		sort[1] = sort16;
+		sort[2] = sort32;
+		sort[3] = sort64;
+		instructions = name;
+	}
+};
+
+inline const NetworkKernels &networkKernels() {
+	static const NetworkKernels kernels;
+	return kernels;
+}
+
+}
+
+const int NETWORK_MAX_SIZE = 64;
+
+/**
+* the instruction set of the networks on this processor: avx2, sse4.1 or scalar
+*/
+inline const char *sortingNetworkInstructions() {
+	return detail::networkKernels().instructions;
+}
+
+/**
+* sorts size ints, 8, 16, 32 or 64, with the bitonic network of that size
+*/
+inline void networkSort(int *values, int size) {
+	switch (size) {
+	case 8: detail::networkKernels().sort[0](values); break;
+	case 16: detail::networkKernels().sort[1](values); break;
+	case 32: detail::networkKernels().sort[2](values); break;
+	case 64: detail::networkKernels().sort[3](values); break;
+	default: throw "the sorting networks sort 8, 16, 32 or 64 ints";
+	}
+}
+
+/**
+* sorts up to NETWORK_MAX_SIZE ints with the smallest network that holds them
+*/
+inline void sortSmallInts(int *values, int count) {
+	int padded[NETWORK_MAX_SIZE], size = 8;
+
+	if (count > NETWORK_MAX_SIZE) {
+		throw "the sorting networks sort at most 64 ints";
+	}
+	if (count < 2) {
+		return;
+	}
+	while (size < count) {
+		size <<= 1;
+	}
+	memcpy(padded, values, count * sizeof(int));
+	for (int i = count; i < size; i++) {
+		padded[i] = INT_MAX;
+	}
+	networkSort(padded, size);
+	memcpy(values, padded, count * sizeof(int));
+}
+
+}
+
+#endif